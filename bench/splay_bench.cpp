@@ -0,0 +1,94 @@
+#include <Set/Set.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// Zipf-distributed lookups against three tree shapes holding the same keys:
+// random insertion order (unbalanced), median-first insertion order
+// (perfectly balanced), and random insertion order in splay mode.
+//
+//     splay_bench [keys] [lookups] [zipf exponent]
+
+typedef Set<int> PlainSet;
+typedef Set<int, iterator_order_traits::inorder_iterator_tag, std::less<int>, std::allocator<int>, 0,
+    tree_shape_traits::splay_shape_tag> SplaySet;
+
+// Keys in an order whose plain insertion yields a perfectly balanced tree
+void median_order(const std::vector<int>& sorted, std::size_t first, std::size_t last, std::vector<int>& out) {
+    if (first == last) { return; }
+    std::size_t middle = first + (last - first) / 2;
+    out.push_back(sorted[middle]);
+    median_order(sorted, first, middle, out);
+    median_order(sorted, middle + 1, last, out);
+}
+
+std::vector<int> zipf_queries(std::size_t keys, std::size_t lookups, double exponent, std::mt19937_64& rng) {
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (std::size_t rank = 0; rank < keys; rank++) {
+        sum += 1.0 / std::pow(static_cast<double>(rank + 1), exponent);
+        cdf[rank] = sum;
+    }
+
+    // Hot ranks are scattered over the key space rather than clustered
+    std::vector<int> key_of_rank(keys);
+    std::iota(key_of_rank.begin(), key_of_rank.end(), 0);
+    std::shuffle(key_of_rank.begin(), key_of_rank.end(), rng);
+
+    std::uniform_real_distribution<double> uniform(0, sum);
+    std::vector<int> queries(lookups);
+    for (int& query : queries) {
+        std::size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+        query = key_of_rank[std::min(rank, keys - 1)];
+    }
+    return queries;
+}
+
+template <typename _Set, typename _Lookup>
+void run(const char* name, _Set& set, const std::vector<int>& queries, _Lookup lookup) {
+    auto start = std::chrono::steady_clock::now();
+    std::size_t hits = 0;
+    for (int query : queries) { hits += lookup(set, query); }
+    auto stop = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(stop - start).count() / queries.size();
+    std::printf("%-28s %8.1f ns/lookup  (%zu hits)\n", name, ns, hits);
+}
+
+int main(int argc, char** argv) {
+    std::size_t keys = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::size_t lookups = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+    double exponent = (argc > 3) ? std::strtod(argv[3], nullptr) : 1.0;
+
+    std::mt19937_64 rng(42);
+    std::vector<int> sorted(keys);
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::vector<int> shuffled = sorted;
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    std::vector<int> balanced;
+    balanced.reserve(keys);
+    median_order(sorted, 0, keys, balanced);
+
+    std::vector<int> queries = zipf_queries(keys, lookups, exponent, rng);
+    std::printf("%zu keys, %zu lookups, zipf exponent %.2f\n", keys, lookups, exponent);
+
+    PlainSet unbalanced_set;
+    for (int key : shuffled) { unbalanced_set.insert(key); }
+    run("unbalanced", unbalanced_set, queries, [](PlainSet& s, int key) { return s.contains(key); });
+
+    PlainSet balanced_set;
+    for (int key : balanced) { balanced_set.insert(key); }
+    run("balanced", balanced_set, queries, [](PlainSet& s, int key) { return s.contains(key); });
+
+    SplaySet splay_set;
+    for (int key : shuffled) { splay_set.insert(key); }
+    run("splay", splay_set, queries, [](SplaySet& s, int key) { return s.contains(key); });
+    // Read-only lookups on the shape the splaying pass left behind
+    run("splay, then peek", splay_set, queries, [](SplaySet& s, int key) { return s.peek(key); });
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <vector>
+#include "declarations.hpp"
+
+// Bloom filter whose bits for a key all live in one 64-byte block: the hash
+// picks a block and then one bit in each of its eight words, so a query
+// costs a single cache line.
+
+class BloomFilter {
+public:
+    typedef std::size_t     size_type;
+    typedef std::uint64_t   hash_type;
+
+    BloomFilter()
+        : _blocks()
+    {}
+
+    // Drops all keys and sizes the filter for the given number of keys
+    void reset(size_type keys, double bits_per_key) {
+        size_type bits = static_cast<size_type>(keys * bits_per_key);
+        size_type blocks = (bits + _block_bits - 1) / _block_bits;
+        _blocks.assign(blocks > 0 ? blocks : 1, _Block());
+    }
+
+    void clear() { _blocks.clear(); }
+
+    void insert(hash_type hash) {
+        _Block& block = _blocks[_block_index(hash)];
+        for (size_type i = 0; i < _word_count; i++) {
+            block._words[i] |= _mask(hash, i);
+        }
+    }
+
+    bool may_contain(hash_type hash) const {
+        const _Block& block = _blocks[_block_index(hash)];
+        bool result = true;
+        for (size_type i = 0; i < _word_count; i++) {
+            hash_type mask = _mask(hash, i);
+            result &= (block._words[i] & mask) == mask;
+        }
+        return result;
+    }
+
+    // Chance that a key never inserted passes, from the current bit density
+    double false_positive_rate() const {
+        if (_blocks.empty()) { return 0; }
+
+        double sum = 0;
+        for (const _Block& block : _blocks) {
+            double rate = 1;
+            for (size_type i = 0; i < _word_count; i++) {
+                rate *= std::popcount(block._words[i]) / 64.0;
+            }
+            sum += rate;
+        }
+        return sum / _blocks.size();
+    }
+
+    size_type memory_usage() const { return _blocks.size() * sizeof(_Block); }
+
+    // Spreads the bits of a hash that may be weak, such as std::hash on integers
+    static hash_type mix(hash_type hash) {
+        hash ^= hash >> 30;
+        hash *= 0xbf58476d1ce4e5b9ULL;
+        hash ^= hash >> 27;
+        hash *= 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+        return hash;
+    }
+
+private:
+    static constexpr size_type _word_count = 8;
+    static constexpr size_type _block_bits = 512;
+
+    struct alignas(64) _Block {
+        hash_type _words[_word_count] = {};
+    };
+
+    std::vector<_Block> _blocks;
+
+    size_type _block_index(hash_type hash) const
+        { return static_cast<size_type>(((hash >> 32) * _blocks.size()) >> 32); }
+
+    // The low half of the hash, multiplied by an odd salt per word, selects
+    // one of the 64 bits of that word
+    static hash_type _mask(hash_type hash, size_type word) {
+        static constexpr std::uint32_t salt[_word_count] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+        };
+        std::uint32_t bit = (static_cast<std::uint32_t>(hash) * salt[word]) >> 26;
+        return hash_type(1) << bit;
+    }
+};
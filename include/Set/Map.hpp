@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "declarations.hpp"
+#include "Tree.hpp"
+#include "Node.hpp"
+#include "TreeIterator.hpp"
+
+// Ordered map split into hot and cold parts. Tree nodes hold only the key,
+// the links and a 32-bit slot number; values live in a separate payload
+// arena, so a search touches key bytes and nothing else. Slots freed by
+// erase are reused, and a value never moves once constructed.
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+class Map {
+    struct _Entry {
+        _Key            _key;
+        std::uint32_t   _slot;  // index of the value in the payload arena
+    };
+
+    // Orders entries by key and also compares entries with bare keys, so a
+    // lookup never has to build an entry
+    struct _EntryCompare {
+        _Compare _less;
+
+        bool operator()(const _Entry& a, const _Entry& b) const { return _less(a._key, b._key); }
+        bool operator()(const _Entry& a, const _Key& b) const { return _less(a._key, b); }
+        bool operator()(const _Key& a, const _Entry& b) const { return _less(a, b._key); }
+    };
+
+public:
+    typedef _Key            key_type;
+    typedef _Value          mapped_type;
+    typedef _Compare        key_compare;
+    typedef _Allocator      allocator_type;
+    typedef std::size_t     size_type;
+
+    typedef Node<_Entry>                                                   node_type;
+    typedef node_type*                                                     node_ptr;
+    typedef Tree<_Entry, node_type, _EntryCompare, allocator_type, 0, tree_shape_traits::static_shape_tag>    tree_type;
+    typedef TreeIterator<_Entry, iterator_order_traits::inorder_iterator_tag, node_type>    tree_iterator;
+
+    typedef MapIterator<_Key, _Value, _Compare, _Allocator>    iterator;
+    typedef const iterator                                     const_iterator;
+
+    Map()
+        : _tree(), _values(), _free_slots()
+    {}
+
+    Map(const Map& other) = default;
+
+    Map(Map&& other) = default;
+
+    Map& operator=(const Map& other) = default;
+
+    Map& operator=(Map&& other) = default;
+
+    ~Map() = default;
+
+    iterator begin() {
+        return iterator(this, tree_iterator(_tree.root_address(),
+            _find_begin_node(_tree.root(), iterator_order_traits::inorder_iterator_tag())));
+    }
+
+    iterator end() { return iterator(this, tree_iterator(_tree.root_address(), nullptr)); }
+
+    // Constructs the value from args only when key is missing; an existing
+    // key costs one search and no allocation
+    template <typename... _Args>
+    std::pair<iterator, bool> try_emplace(const key_type& key, _Args&&... args)
+        { return _try_emplace(key, std::forward<_Args>(args)...); }
+
+    template <typename... _Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, _Args&&... args)
+        { return _try_emplace(std::move(key), std::forward<_Args>(args)...); }
+
+    // Assigns to the value in place when key exists, otherwise inserts
+    template <typename _M>
+    std::pair<iterator, bool> insert_or_assign(const key_type& key, _M&& value)
+        { return _insert_or_assign(key, std::forward<_M>(value)); }
+
+    template <typename _M>
+    std::pair<iterator, bool> insert_or_assign(key_type&& key, _M&& value)
+        { return _insert_or_assign(std::move(key), std::forward<_M>(value)); }
+
+    mapped_type& operator[](const key_type& key) { return *_value_of(try_emplace(key).first); }
+
+    mapped_type& operator[](key_type&& key) { return *_value_of(try_emplace(std::move(key)).first); }
+
+    mapped_type& at(const key_type& key) {
+        node_ptr node = _tree.find(key);
+        if (node == nullptr) { throw std::out_of_range("Map::at: key not found"); }
+        return *_values[node->_key._slot];
+    }
+
+    const mapped_type& at(const key_type& key) const {
+        node_ptr node = _tree.find(key);
+        if (node == nullptr) { throw std::out_of_range("Map::at: key not found"); }
+        return *_values[node->_key._slot];
+    }
+
+    bool contains(const key_type& key) const { return _tree.find(key) != nullptr; }
+
+    iterator find(const key_type& key) { return _make_iterator(_tree.find(key)); }
+
+    bool erase(const key_type& key) {
+        node_ptr node = _tree.find(key);
+        if (node == nullptr) { return false; }
+
+        _release_slot(node->_key._slot);
+        _tree.remove(node);
+        return true;
+    }
+
+    // Iterators to other elements stay valid
+    iterator erase(iterator pos) {
+        iterator next = pos;
+        ++next;
+        _release_slot(pos._it.node()->_key._slot);
+        _tree.remove(pos._it.node());
+
+        return _make_iterator(next._it.node());
+    }
+
+    void clear() {
+        _tree.clear();
+        _values.clear();
+        _free_slots.clear();
+    }
+
+    bool empty() const { return _tree.empty(); }
+
+    size_type size() const { return _tree.size(); }
+
+private:
+    friend class MapIterator<_Key, _Value, _Compare, _Allocator>;
+
+    typedef typename std::allocator_traits<allocator_type>::template rebind_alloc<std::optional<mapped_type>> payload_allocator;
+
+    tree_type                                                  _tree;
+    std::deque<std::optional<mapped_type>, payload_allocator>  _values;      // payload arena, grows without moving values
+    std::vector<std::uint32_t>                                 _free_slots;
+
+    iterator _make_iterator(node_ptr node) { return iterator(this, tree_iterator(_tree.root_address(), node)); }
+
+    mapped_type* _value_of(const iterator& it) { return &*_values[it._it.node()->_key._slot]; }
+
+    template <typename _K, typename... _Args>
+    std::pair<iterator, bool> _try_emplace(_K&& key, _Args&&... args) {
+        node_ptr node = _tree.find(key);
+        if (node != nullptr) { return std::pair<iterator, bool>(_make_iterator(node), false); }
+
+        std::uint32_t slot = _acquire_slot(std::forward<_Args>(args)...);
+        node = _tree.insert(_Entry{ std::forward<_K>(key), slot });
+        return std::pair<iterator, bool>(_make_iterator(node), true);
+    }
+
+    template <typename _K, typename _M>
+    std::pair<iterator, bool> _insert_or_assign(_K&& key, _M&& value) {
+        node_ptr node = _tree.find(key);
+        if (node != nullptr) {
+            *_values[node->_key._slot] = std::forward<_M>(value);
+            return std::pair<iterator, bool>(_make_iterator(node), false);
+        }
+
+        std::uint32_t slot = _acquire_slot(std::forward<_M>(value));
+        node = _tree.insert(_Entry{ std::forward<_K>(key), slot });
+        return std::pair<iterator, bool>(_make_iterator(node), true);
+    }
+
+    // Constructs a value in a free slot, appending one if there is none
+    template <typename... _Args>
+    std::uint32_t _acquire_slot(_Args&&... args) {
+        if (_free_slots.empty()) {
+            if (_values.size() > std::numeric_limits<std::uint32_t>::max()) { throw std::length_error("Map payload arena is full"); }
+            _values.emplace_back(std::in_place, std::forward<_Args>(args)...);
+            return static_cast<std::uint32_t>(_values.size() - 1);
+        }
+
+        std::uint32_t slot = _free_slots.back();
+        _values[slot].emplace(std::forward<_Args>(args)...);
+        _free_slots.pop_back();
+        return slot;
+    }
+
+    void _release_slot(std::uint32_t slot) {
+        _values[slot].reset();
+        _free_slots.push_back(slot);
+    }
+};
+
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+class MapIterator {
+public:
+    typedef Map<_Key, _Value, _Compare, _Allocator>         map_type;
+    typedef typename map_type::tree_iterator                tree_iterator;
+
+    typedef _Key                                            key_type;
+    typedef _Value                                          mapped_type;
+    typedef std::pair<const key_type&, mapped_type&>        value_type;
+    typedef value_type                                      reference;
+    typedef std::ptrdiff_t                                  difference_type;
+    typedef std::bidirectional_iterator_tag                 iterator_category;
+
+    // Keys and values live apart, so elements are handed out as a pair of references
+    struct pointer {
+        reference _pair;
+
+        const reference* operator->() const { return &_pair; }
+    };
+
+    MapIterator(map_type* map, tree_iterator it)
+        : _map(map), _it(it)
+    {}
+
+    bool operator==(const MapIterator& other) const { return _it == other._it; }
+
+    bool operator!=(const MapIterator& other) const { return !((*this) == other); }
+
+    MapIterator& operator++() {
+        ++_it;
+        return *this;
+    }
+
+    MapIterator operator++(int) {
+        MapIterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    MapIterator& operator--() {
+        --_it;
+        return *this;
+    }
+
+    MapIterator operator--(int) {
+        MapIterator tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    reference operator*() const { return reference(key(), value()); }
+
+    pointer operator->() const { return pointer{ **this }; }
+
+    const key_type& key() const { return _it.node()->_key._key; }
+
+    mapped_type& value() const { return *_map->_values[_it.node()->_key._slot]; }
+
+private:
+    friend class Map<_Key, _Value, _Compare, _Allocator>;
+
+    map_type*       _map;
+    tree_iterator   _it;
+};
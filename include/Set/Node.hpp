@@ -1,10 +1,15 @@
 #pragma once
+#include <type_traits>
+#include <utility>
 #include "declarations.hpp"
 
-template <typename _Tp>
+template <typename _Tp, typename _Aggregate>
 struct Node {
-    typedef Node*   pointer;
-    typedef _Tp     key_type;
+    typedef Node*           pointer;
+    typedef _Tp             key_type;
+    typedef std::size_t     size_type;
+    typedef _Aggregate                          aggregate_type;
+    typedef typename _Aggregate::value_type     summary_type;
 
     key_type _key;
 
@@ -12,34 +17,70 @@ struct Node {
     pointer _right;
     pointer _parent;
 
+    size_type _count;       // live nodes in the subtree rooted here
+    size_type _tombstones;  // erased nodes in the subtree still awaiting compaction
+    bool _dead;
+
+    [[no_unique_address]] summary_type _summary;  // aggregate over the live keys of the subtree
+
     Node()
-        : _left(nullptr), _right(nullptr), _parent(nullptr)
+        : _left(nullptr), _right(nullptr), _parent(nullptr), _count(1), _tombstones(0), _dead(false), _summary()
     {}
 
     Node(key_type key)
-        : _key(key), _left(nullptr), _right(nullptr), _parent(nullptr)
+        : _key(std::move(key)), _left(nullptr), _right(nullptr), _parent(nullptr), _count(1), _tombstones(0), _dead(false), _summary()
     {}
     
     Node(key_type key, pointer left, pointer right)
-        : _key(key), _left(left), _right(right), _parent(nullptr)
+        : _key(std::move(key)), _left(left), _right(right), _parent(nullptr), _count(1), _tombstones(0), _dead(false), _summary()
     {}
 };
 
 // Subtree checks
 
-template <typename _Tp>
-bool _has_left_subtree(Node<_Tp>* node)
+template <typename _Tp, typename _Aggregate>
+bool _has_left_subtree(Node<_Tp, _Aggregate>* node)
     { return (node->_left != nullptr); }
 
-template <typename _Tp>
-bool _has_right_subtree(Node<_Tp>* node)
+template <typename _Tp, typename _Aggregate>
+bool _has_right_subtree(Node<_Tp, _Aggregate>* node)
     { return (node->_right != nullptr); }
 
+// Subtree size
+
+template <typename _Tp, typename _Aggregate>
+std::size_t _subtree_count(Node<_Tp, _Aggregate>* node)
+    { return (node == nullptr) ? 0 : node->_count; }
+
+template <typename _Tp, typename _Aggregate>
+std::size_t _subtree_tombstones(Node<_Tp, _Aggregate>* node)
+    { return (node == nullptr) ? 0 : node->_tombstones; }
+
+// Subtree aggregate
+
+template <typename _Tp, typename _Aggregate>
+void _update_summary(Node<_Tp, _Aggregate>* node) {
+    if constexpr (!std::is_same_v<_Aggregate, no_aggregate>) {
+        typename _Aggregate::value_type value = node->_dead ? _Aggregate::identity() : _Aggregate::lift(node->_key);
+        if (node->_left != nullptr) { value = _Aggregate::combine(node->_left->_summary, value); }
+        if (node->_right != nullptr) { value = _Aggregate::combine(value, node->_right->_summary); }
+        node->_summary = value;
+    }
+}
+
+// Recomputes everything a node keeps about its subtree from its children
+template <typename _Tp, typename _Aggregate>
+void _update_node(Node<_Tp, _Aggregate>* node) {
+    node->_count = !node->_dead + _subtree_count(node->_left) + _subtree_count(node->_right);
+    node->_tombstones = node->_dead + _subtree_tombstones(node->_left) + _subtree_tombstones(node->_right);
+    _update_summary(node);
+}
+
 // Find begin node
 
-template <typename _Tp>
-Node<_Tp>* _find_begin_node(Node<_Tp>* root, iterator_order_traits::inorder_iterator_tag) {
-    Node<_Tp>* node = root;
+template <typename _Tp, typename _Aggregate>
+Node<_Tp, _Aggregate>* _find_begin_node(Node<_Tp, _Aggregate>* root, iterator_order_traits::inorder_iterator_tag) {
+    Node<_Tp, _Aggregate>* node = root;
     if (node == nullptr) { return nullptr; }
     while (_has_left_subtree(node)) {
         node = node->_left;
@@ -47,13 +88,13 @@ Node<_Tp>* _find_begin_node(Node<_Tp>* root, iterator_order_traits::inorder_iter
     return node;
 }
 
-template <typename _Tp>
-Node<_Tp>* _find_begin_node(Node<_Tp>* root, iterator_order_traits::preorder_iterator_tag) 
+template <typename _Tp, typename _Aggregate>
+Node<_Tp, _Aggregate>* _find_begin_node(Node<_Tp, _Aggregate>* root, iterator_order_traits::preorder_iterator_tag) 
     { return root; }  
 
-template <typename _Tp>
-Node<_Tp>* _find_begin_node(Node<_Tp>* root, iterator_order_traits::postorder_iterator_tag) {
-    Node<_Tp>* node = root;
+template <typename _Tp, typename _Aggregate>
+Node<_Tp, _Aggregate>* _find_begin_node(Node<_Tp, _Aggregate>* root, iterator_order_traits::postorder_iterator_tag) {
+    Node<_Tp, _Aggregate>* node = root;
     if (node == nullptr) { return nullptr; }
     while (_has_left_subtree(node) || _has_right_subtree(node)) {
         if (_has_left_subtree(node)) { node = node->_left; }
@@ -64,9 +105,9 @@ Node<_Tp>* _find_begin_node(Node<_Tp>* root, iterator_order_traits::postorder_it
 
 // Find rbegin node
 
-template <typename _Tp>
-Node<_Tp>* _find_rbegin_node(Node<_Tp>* root, iterator_order_traits::inorder_iterator_tag) {
-    Node<_Tp>* node = root;
+template <typename _Tp, typename _Aggregate>
+Node<_Tp, _Aggregate>* _find_rbegin_node(Node<_Tp, _Aggregate>* root, iterator_order_traits::inorder_iterator_tag) {
+    Node<_Tp, _Aggregate>* node = root;
     if (node == nullptr) { return nullptr; }
     while (_has_right_subtree(node)) {
         node = node->_right;
@@ -74,9 +115,9 @@ Node<_Tp>* _find_rbegin_node(Node<_Tp>* root, iterator_order_traits::inorder_ite
     return node;
 }
 
-template <typename _Tp>
-Node<_Tp>* _find_rbegin_node(Node<_Tp>* root, iterator_order_traits::preorder_iterator_tag) {
-    Node<_Tp>* node = root;
+template <typename _Tp, typename _Aggregate>
+Node<_Tp, _Aggregate>* _find_rbegin_node(Node<_Tp, _Aggregate>* root, iterator_order_traits::preorder_iterator_tag) {
+    Node<_Tp, _Aggregate>* node = root;
     if (node == nullptr) { return nullptr; }
     while (_has_left_subtree(node) || _has_right_subtree(node)) {
         if (_has_right_subtree(node)) { node = node->_right; }
@@ -85,6 +126,6 @@ Node<_Tp>* _find_rbegin_node(Node<_Tp>* root, iterator_order_traits::preorder_it
     return node;
 }
 
-template <typename _Tp>
-Node<_Tp>* _find_rbegin_node(Node<_Tp>* root, iterator_order_traits::postorder_iterator_tag) 
+template <typename _Tp, typename _Aggregate>
+Node<_Tp, _Aggregate>* _find_rbegin_node(Node<_Tp, _Aggregate>* root, iterator_order_traits::postorder_iterator_tag) 
     { return root; }
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <bitset>
+#include <functional>
+#include "declarations.hpp"
+
+// Fixed number of node slots stored inside the owning tree. Slots are handed
+// out before the tree falls back to its allocator, so small trees never touch
+// the heap and keep all their nodes within a few cache lines.
+
+template <typename _TreeNode, std::size_t _N>
+class NodePool {
+public:
+    typedef _TreeNode       node_type;
+    typedef _TreeNode*      pointer;
+    typedef std::size_t     size_type;
+
+    NodePool()
+        : _used(), _count(0)
+    {}
+
+    // Slots are addressed by the tree's nodes, so a pool is never copied
+    NodePool(const NodePool& other) = delete;
+
+    NodePool& operator=(const NodePool& other) = delete;
+
+    // Raw storage for one node, nullptr once every slot is taken
+    pointer allocate() {
+        if (_count == _N) { return nullptr; }
+        size_type i = 0;
+        while (_used.test(i)) { i++; }
+        _used.set(i);
+        _count++;
+        return &_slots[i]._node;
+    }
+
+    void deallocate(pointer node) {
+        _used.reset(_index_of(node));
+        _count--;
+    }
+
+    bool owns(pointer node) const {
+        std::less<const void*> less;
+        return !less(node, _slots) && less(node, _slots + _N);
+    }
+
+    size_type capacity() const { return _N; }
+
+    size_type count() const { return _count; }
+
+    bool used(size_type i) const { return _used.test(i); }
+
+    pointer node(size_type i) { return &_slots[i]._node; }
+
+private:
+    union _Slot {
+        node_type _node;
+
+        _Slot() {}
+        ~_Slot() {}
+    };
+
+    _Slot               _slots[_N];
+    std::bitset<_N>     _used;
+    size_type           _count;
+
+    size_type _index_of(pointer node) const
+        { return reinterpret_cast<const _Slot*>(node) - _slots; }
+};
+
+template <typename _TreeNode>
+class NodePool<_TreeNode, 0> {
+public:
+    typedef _TreeNode       node_type;
+    typedef _TreeNode*      pointer;
+    typedef std::size_t     size_type;
+
+    pointer allocate() { return nullptr; }
+
+    void deallocate(pointer) {}
+
+    bool owns(pointer) const { return false; }
+
+    size_type capacity() const { return 0; }
+
+    size_type count() const { return 0; }
+
+    bool used(size_type) const { return false; }
+
+    pointer node(size_type) { return nullptr; }
+};
+
+// Contiguous run of nodes allocated in one piece, for example by a layout
+// pass. Nodes are destroyed one by one as they are erased and the run is
+// released with the last of them; a run may be shared by the trees that
+// split or join nodes out of it.
+
+template <typename _TreeNode>
+struct NodeBlock {
+    typedef _TreeNode*      pointer;
+    typedef std::size_t     size_type;
+
+    pointer     _nodes;     // nullptr once released
+    size_type   _capacity;
+    size_type   _live;
+
+    bool owns(pointer node) const {
+        std::less<const void*> less;
+        return _nodes != nullptr && !less(node, _nodes) && less(node, _nodes + _capacity);
+    }
+};
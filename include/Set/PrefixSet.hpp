@@ -0,0 +1,345 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "declarations.hpp"
+
+// String set stored as front-coded sorted blocks. Each block keeps its first
+// key verbatim and every following key as (shared prefix length, suffix)
+// relative to its predecessor, so common prefixes are stored once per run.
+
+template <std::size_t _BlockSize>
+class PrefixSet {
+public:
+    typedef std::string     key_type;
+    typedef key_type        value_type;
+    typedef std::size_t     size_type;
+
+    typedef PrefixSetIterator<_BlockSize>    iterator;
+    typedef const iterator                   const_iterator;
+
+    static_assert(_BlockSize > 0, "PrefixSet block size must be positive");
+
+    PrefixSet()
+        : _blocks(), _size(0)
+    {}
+
+    PrefixSet(const PrefixSet& other) = default;
+
+    PrefixSet(PrefixSet&& other)
+        : _blocks(std::move(other._blocks)), _size(other._size)
+    { other._size = 0; }
+
+    PrefixSet& operator=(const PrefixSet& other) = default;
+
+    PrefixSet& operator=(PrefixSet&& other) {
+        _blocks = std::move(other._blocks);
+        _size = other._size;
+        other._size = 0;
+
+        return *this;
+    }
+
+    ~PrefixSet() = default;
+
+    bool operator==(const PrefixSet& other) const {
+        if (_size != other._size) { return false; }
+        return std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const PrefixSet& other) const { return !((*this) == other); }
+
+    iterator begin() const { return _seek(0, 0); }
+
+    iterator end() const { return iterator(this, _blocks.size(), 0, 0, key_type()); }
+
+    const_iterator cbegin() const { return begin(); }
+
+    const_iterator cend() const { return end(); }
+
+    std::pair<iterator, bool> insert(const key_type& key) {
+        if (_blocks.empty()) {
+            _blocks.push_back(_encode(&key, &key + 1));
+            _size++;
+            return std::pair<iterator, bool>(begin(), true);
+        }
+
+        size_type block = _block_for(key);
+        std::vector<key_type> keys = _decode(_blocks[block]);
+        auto pos = std::lower_bound(keys.begin(), keys.end(), key);
+        size_type index = pos - keys.begin();
+        if (pos != keys.end() && *pos == key) {
+            return std::pair<iterator, bool>(_seek(block, index), false);
+        }
+
+        keys.insert(pos, key);
+        _size++;
+
+        if (keys.size() > 2 * _BlockSize) {
+            size_type half = keys.size() / 2;
+            _blocks[block] = _encode(keys.data(), keys.data() + half);
+            _blocks.insert(_blocks.begin() + block + 1, _encode(keys.data() + half, keys.data() + keys.size()));
+            if (index >= half) {
+                block++;
+                index -= half;
+            }
+        } else {
+            _blocks[block] = _encode(keys.data(), keys.data() + keys.size());
+        }
+
+        return std::pair<iterator, bool>(_seek(block, index), true);
+    }
+
+    bool erase(const key_type& key) {
+        size_type block, index, offset;
+        if (!_locate(key, block, index, offset)) { return false; }
+
+        std::vector<key_type> keys = _decode(_blocks[block]);
+        keys.erase(keys.begin() + index);
+        _size--;
+
+        if (keys.empty()) {
+            _blocks.erase(_blocks.begin() + block);
+            return true;
+        }
+
+        // Fold small neighbours together so erase-heavy runs keep compressing well
+        if (block + 1 < _blocks.size() && keys.size() + _blocks[block + 1]._count <= _BlockSize) {
+            std::vector<key_type> next = _decode(_blocks[block + 1]);
+            keys.insert(keys.end(), next.begin(), next.end());
+            _blocks.erase(_blocks.begin() + block + 1);
+        }
+        _blocks[block] = _encode(keys.data(), keys.data() + keys.size());
+
+        return true;
+    }
+
+    bool contains(const key_type& key) const {
+        size_type block, index, offset;
+        return _locate(key, block, index, offset);
+    }
+
+    iterator find(const key_type& key) const {
+        size_type block, index, offset;
+        if (!_locate(key, block, index, offset)) { return end(); }
+        return iterator(this, block, index, offset, key);
+    }
+
+    void clear() {
+        _blocks.clear();
+        _size = 0;
+    }
+
+    bool empty() const { return _size == 0; }
+
+    size_type size() const { return _size; }
+
+private:
+    friend class PrefixSetIterator<_BlockSize>;
+
+    struct _Block {
+        key_type    _head;      // first key, stored verbatim
+        std::string _tail;      // remaining keys as varint lcp, varint length, suffix bytes
+        size_type   _count;     // keys in the block, head included
+    };
+
+    std::vector<_Block>     _blocks;
+    size_type               _size;
+
+    static void _put_varint(std::string& out, size_type value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    static size_type _get_varint(const std::string& in, size_type& pos) {
+        size_type value = 0;
+        int shift = 0;
+        unsigned char byte;
+        do {
+            byte = static_cast<unsigned char>(in[pos++]);
+            value |= static_cast<size_type>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        return value;
+    }
+
+    static size_type _common_prefix(const char* a, size_type a_len, const char* b, size_type b_len) {
+        size_type n = std::min(a_len, b_len);
+        size_type i = 0;
+        while (i < n && a[i] == b[i]) { i++; }
+        return i;
+    }
+
+    // Reads the entry at pos and rewrites key from its predecessor in place
+    static void _decode_next(const _Block& block, size_type& pos, key_type& key) {
+        size_type lcp = _get_varint(block._tail, pos);
+        size_type length = _get_varint(block._tail, pos);
+        key.resize(lcp);
+        key.append(block._tail, pos, length);
+        pos += length;
+    }
+
+    static _Block _encode(const key_type* first, const key_type* last) {
+        _Block block;
+        block._head = *first;
+        block._count = last - first;
+        for (const key_type* prev = first++; first != last; prev = first++) {
+            size_type lcp = _common_prefix(prev->data(), prev->size(), first->data(), first->size());
+            _put_varint(block._tail, lcp);
+            _put_varint(block._tail, first->size() - lcp);
+            block._tail.append(*first, lcp, std::string::npos);
+        }
+        return block;
+    }
+
+    static std::vector<key_type> _decode(const _Block& block) {
+        std::vector<key_type> keys;
+        keys.reserve(block._count);
+        keys.push_back(block._head);
+
+        key_type key = block._head;
+        size_type pos = 0;
+        for (size_type i = 1; i < block._count; i++) {
+            _decode_next(block, pos, key);
+            keys.push_back(key);
+        }
+        return keys;
+    }
+
+    // Block whose key range covers key; keys below every head land in block 0
+    size_type _block_for(const key_type& key) const {
+        auto it = std::upper_bound(_blocks.begin(), _blocks.end(), key,
+            [](const key_type& k, const _Block& b) { return k < b._head; });
+        return (it == _blocks.begin()) ? 0 : (it - _blocks.begin()) - 1;
+    }
+
+    // Scans one block without materialising its keys. `matched` is the common
+    // prefix of key and the current entry, which is always smaller than key;
+    // each entry's lcp alone decides whether it can still equal key.
+    bool _locate(const key_type& key, size_type& block, size_type& index, size_type& offset) const {
+        if (_blocks.empty()) { return false; }
+
+        block = _block_for(key);
+        const _Block& b = _blocks[block];
+        if (key < b._head) { return false; }
+
+        size_type matched = _common_prefix(b._head.data(), b._head.size(), key.data(), key.size());
+        if (matched == key.size() && matched == b._head.size()) {
+            index = 0;
+            offset = 0;
+            return true;
+        }
+
+        size_type pos = 0;
+        for (size_type i = 1; i < b._count; i++) {
+            size_type lcp = _get_varint(b._tail, pos);
+            size_type length = _get_varint(b._tail, pos);
+            const char* suffix = b._tail.data() + pos;
+            pos += length;
+
+            if (lcp > matched) { continue; }
+            if (lcp < matched) { return false; }
+
+            size_type m = _common_prefix(suffix, length, key.data() + matched, key.size() - matched);
+            matched += m;
+            if (m == length) {
+                if (matched == key.size()) {
+                    index = i;
+                    offset = pos;
+                    return true;
+                }
+                continue;
+            }
+            if (matched == key.size()) { return false; }
+            if (static_cast<unsigned char>(suffix[m]) > static_cast<unsigned char>(key[matched])) { return false; }
+        }
+
+        return false;
+    }
+
+    // Iterator at entry index of block, decoding from the block head
+    iterator _seek(size_type block, size_type index) const {
+        if (block >= _blocks.size()) { return end(); }
+
+        const _Block& b = _blocks[block];
+        key_type key = b._head;
+        size_type pos = 0;
+        for (size_type i = 0; i < index; i++) {
+            _decode_next(b, pos, key);
+        }
+        return iterator(this, block, index, pos, std::move(key));
+    }
+};
+
+template <std::size_t _BlockSize>
+class PrefixSetIterator {
+public:
+    typedef std::string                         key_type;
+    typedef key_type                            value_type;
+    typedef std::ptrdiff_t                      difference_type;
+    typedef const key_type*                     pointer;
+    typedef const key_type&                     reference;
+    typedef std::bidirectional_iterator_tag     iterator_category;
+
+    typedef PrefixSet<_BlockSize>               set_type;
+    typedef std::size_t                         size_type;
+
+    PrefixSetIterator(const set_type* set, size_type block, size_type index, size_type offset, key_type key)
+        : _set(set), _block(block), _index(index), _offset(offset), _key(std::move(key))
+    {}
+
+    bool operator==(const PrefixSetIterator& other) const
+        { return (_set == other._set && _block == other._block && _index == other._index); }
+
+    bool operator!=(const PrefixSetIterator& other) const
+        { return !((*this) == other); }
+
+    PrefixSetIterator& operator++() {
+        const auto& block = _set->_blocks[_block];
+        if (_index + 1 < block._count) {
+            set_type::_decode_next(block, _offset, _key);
+            _index++;
+        } else {
+            *this = _set->_seek(_block + 1, 0);
+        }
+        return *this;
+    }
+
+    PrefixSetIterator operator++(int) {
+        PrefixSetIterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    // Front coding only decodes forwards, so stepping back re-decodes the block
+    PrefixSetIterator& operator--() {
+        if (_index > 0) {
+            *this = _set->_seek(_block, _index - 1);
+        } else if (_block > 0) {
+            *this = _set->_seek(_block - 1, _set->_blocks[_block - 1]._count - 1);
+        }
+        return *this;
+    }
+
+    PrefixSetIterator operator--(int) {
+        PrefixSetIterator tmp = *this;
+        --(*this);
+        return tmp;
+    }
+
+    const key_type& operator*() const { return _key; }
+
+    const key_type* operator->() const { return &_key; }
+
+private:
+    const set_type*     _set;
+    size_type           _block;
+    size_type           _index;
+    size_type           _offset;    // position of the next entry in the block tail
+    key_type            _key;       // decoded current key
+};
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <type_traits>
 #include "declarations.hpp"
+#include "BloomFilter.hpp"
 #include "Tree.hpp"
 #include "Node.hpp"
 #include "TreeIterator.hpp"
@@ -8,7 +12,10 @@
 template < typename _Tp, 
     typename _OrderTag,
     typename _Compare,
-    typename _Allocator>
+    typename _Allocator,
+    std::size_t _InlineCapacity,
+    typename _ShapeTag,
+    typename _Aggregate>
 class Set {
 public:
 
@@ -18,13 +25,16 @@ public:
     typedef key_compare    value_compare;
     typedef _Allocator     allocator_type;
     typedef _OrderTag      order_tag;
+    typedef _ShapeTag      shape_tag;
+    typedef _Aggregate     aggregate_type;
+    typedef typename aggregate_type::value_type   summary_type;
     typedef std::size_t    size_type;
 
-    typedef Node<key_type>                                            node_type;
+    typedef Node<key_type, aggregate_type>                            node_type;
     typedef node_type*                                                node_ptr;
-    typedef Tree<key_type, node_type, key_compare, allocator_type>    tree_type;
+    typedef Tree<key_type, node_type, key_compare, allocator_type, _InlineCapacity, shape_tag>    tree_type;
 
-    typedef TreeIterator<_Tp, order_tag>             iterator;
+    typedef TreeIterator<_Tp, order_tag, node_type>  iterator;
     typedef const iterator                           const_iterator;
     typedef std::reverse_iterator<iterator>          reverse_iterator;
     typedef std::reverse_iterator<const iterator>    const_reverse_iterator; //
@@ -38,57 +48,91 @@ public:
     }
 
     Set(const Set& other) 
-        : _tree(other._tree), _end_node(nullptr)
+        :   _tree(other._tree),
+            _end_node(nullptr),
+            _bloom(other._bloom),
+            _fingerprint(other._fingerprint),
+            _fingerprint_valid(other._fingerprint_valid)
     {
-        _begin_node = _find_begin_node(_tree.root(), order_tag());
-        _rbegin_node = _find_rbegin_node(_tree.root(), order_tag());
+        _update_boundary_nodes();
     }
 
+    // Nodes kept in other's inline storage are relocated, so the cached
+    // boundary nodes are looked up again
     Set(Set&& other) 
         :   _tree(std::move(other._tree)),
-            _begin_node(std::move(other._begin_node)),
-            _rbegin_node(std::move(other._rbegin_node)), // 
-            _end_node(nullptr)
-    {}
+            _end_node(nullptr),
+            _bloom(std::move(other._bloom)),
+            _fingerprint(other._fingerprint),
+            _fingerprint_valid(other._fingerprint_valid)
+    {
+        _update_boundary_nodes();
+        other._begin_node = nullptr;
+        other._rbegin_node = nullptr;
+        other._bloom = _BloomState();
+        other._fingerprint = 0;
+        other._fingerprint_valid = true;
+    }
 
     Set& operator=(const Set& other) {
         _tree = other._tree;
-        _begin_node = _find_begin_node(_tree.root(), order_tag());
-        _rbegin_node = _find_rbegin_node(_tree.root(), order_tag());
+        _bloom = other._bloom;
+        _fingerprint = other._fingerprint;
+        _fingerprint_valid = other._fingerprint_valid;
+        _update_boundary_nodes();
         _end_node = nullptr;
 
         return *this;
     }
 
     Set& operator=(Set&& other) {
-        _tree = std::move(other._tree),
-        _begin_node = std::move(other._begin_node),
-        _rbegin_node = std::move(other._rbegin_node),
-        _end_node(nullptr);
+        if (this == &other) { return *this; }
+        _tree = std::move(other._tree);
+        _bloom = std::move(other._bloom);
+        _fingerprint = other._fingerprint;
+        _fingerprint_valid = other._fingerprint_valid;
+        _update_boundary_nodes();
+        _end_node = nullptr;
+        other._begin_node = nullptr;
+        other._rbegin_node = nullptr;
+        other._bloom = _BloomState();
+        other._fingerprint = 0;
+        other._fingerprint_valid = true;
+
+        return *this;
     }
 
     ~Set() = default;
 
-    bool operator==(const Set& other) { return _tree == other._tree; }
+    // Sets with different fingerprints are rejected without touching a node.
+    // Only done under std::less, where keys the comparator calls equal are
+    // equal and so hash equally.
+    bool operator==(const Set& other) const {
+        if (_tree.size() != other._tree.size()) { return false; }
+        if constexpr (_hash_matches_compare) {
+            if (fingerprint() != other.fingerprint()) { return false; }
+        }
+        return _tree == other._tree;
+    }
 
-    bool operator!=(const Set& other) { return !((*this) == other); }
+    bool operator!=(const Set& other) const { return !((*this) == other); }
 
 
-    iterator begin() { return iterator(_tree.root(), _begin_node); }
+    iterator begin() { return iterator(_tree.root_address(), _begin_node); }
 
-    iterator end() { return iterator(_tree.root(), _end_node); }
+    iterator end() { return iterator(_tree.root_address(), _end_node); }
 
-    const_iterator cbegin() { return const_iterator(_tree.root(), _begin_node); } // const
+    const_iterator cbegin() { return const_iterator(_tree.root_address(), _begin_node); } // const
 
-    const_iterator cend() { return const_iterator(_tree.root(), _end_node); }
+    const_iterator cend() { return const_iterator(_tree.root_address(), _end_node); }
 
-    reverse_iterator rbegin() { return reverse_iterator(iterator(_tree.root(), _end_node)); } 
+    reverse_iterator rbegin() { return reverse_iterator(iterator(_tree.root_address(), _end_node)); } 
 
-    reverse_iterator rend() { return reverse_iterator(iterator(_tree.root(), _begin_node)); }
+    reverse_iterator rend() { return reverse_iterator(iterator(_tree.root_address(), _begin_node)); }
 
-    const_reverse_iterator crbegin() { return const_reverse_iterator(iterator(_tree.root(), _end_node)); } // const
+    const_reverse_iterator crbegin() { return const_reverse_iterator(iterator(_tree.root_address(), _end_node)); } // const
 
-    const_reverse_iterator crend() { return const_reverse_iterator(iterator(_tree.root(), _begin_node)); }
+    const_reverse_iterator crend() { return const_reverse_iterator(iterator(_tree.root_address(), _begin_node)); }
 
     std::pair<iterator, bool> insert(const _Tp& key) {
         _begin_node = nullptr;
@@ -97,11 +141,15 @@ public:
         size_type start_size = size();
         bool insertion_result = true;
 
-        iterator it(_tree.root(), _tree.insert(key));
+        node_ptr node = _tree.insert(key);
+        iterator it(_tree.root_address(), node);
         if (start_size == size()) { insertion_result = false; }
+        else {
+            _bloom_insert(key);
+            _fingerprint += _hash(node->_key);
+        }
 
-        _begin_node = _find_begin_node<key_type>(_tree.root(), order_tag());
-        _rbegin_node = _find_rbegin_node<key_type>(_tree.root(), order_tag());
+        _update_boundary_nodes();
 
         return std::pair<iterator, bool>(it, insertion_result);
     }
@@ -111,20 +159,155 @@ public:
         _begin_node = nullptr;
         _rbegin_node = nullptr;
         
-        bool result = _tree.remove(key);
+        // The stored key is hashed, which may differ from an equivalent argument
+        node_ptr node = static_cast<const tree_type&>(_tree).find(key);
+        bool result = node != nullptr;
+        if (result) {
+            _fingerprint -= _hash(node->_key);
+            _tree.remove(node);
+            _bloom_erase(1);
+        }
         
-        _begin_node = _find_begin_node(_tree.root(), order_tag());
-        _rbegin_node = _find_rbegin_node(_tree.root(), order_tag());
+        _update_boundary_nodes();
         
         return result;
     }
 
-    bool contains(const _Tp& key) { return _tree.find(key) != nullptr; } // const
+    // Erases the element at pos without searching for it and returns the
+    // iterator following it; iterators to other elements stay valid
+    iterator erase(iterator pos) {
+        iterator next = pos;
+        ++next;
+        _fingerprint -= _hash(*pos);
+        _tree.remove(pos.node());
+        _bloom_erase(1);
+        _update_boundary_nodes();
+
+        return iterator(_tree.root_address(), next.node());
+    }
 
-    iterator find(const key_type& key) { return iterator(_tree.root(), _tree.find()); }
+    // Erases the keys in [*first, *last); whole subtrees are detached at once
+    iterator erase(iterator first, iterator last) {
+        static_assert(std::is_same_v<order_tag, iterator_order_traits::inorder_iterator_tag>,
+            "range erase needs iterators in key order");
+        if (first == last) { return last; }
+
+        node_ptr last_node = last.node();
+        if (last_node == _end_node) { _bloom_erase(_tree.remove_range(*first)); }
+        else { _bloom_erase(_tree.remove_range(*first, *last)); }
+        _fingerprint_valid = false;
+        _update_boundary_nodes();
+
+        return iterator(_tree.root_address(), last_node);
+    }
+
+    // Erases the keys in [lo, hi) and returns how many were removed
+    size_type erase_range(const key_type& lo, const key_type& hi) {
+        size_type removed = _tree.remove_range(lo, hi);
+        _bloom_erase(removed);
+        if (removed > 0) { _fingerprint_valid = false; }
+        _update_boundary_nodes();
+        return removed;
+    }
+
+    // Keeps the keys less than key and returns the rest as a new set
+    Set split(const key_type& key) {
+        Set other(_tree.split(key));
+        other._bloom._bits_per_key = _bloom._bits_per_key;
+        other._bloom._stale = true;
+        other._fingerprint_valid = false;
+        _fingerprint_valid = false;
+        _bloom_erase(other.size());
+        _update_boundary_nodes();
+        return other;
+    }
+
+    // Moves all keys of other into this set, cheapest when the two key
+    // ranges do not overlap
+    void join(Set& other) {
+        if (this == &other) { return; }
+        size_type expected_size = _tree.size() + other._tree.size();
+        _tree.join(other._tree);
+        _bloom._stale = true;
+        other._bloom._stale = true;
+
+        // Overlapping keys were merged, so the sum no longer holds
+        _fingerprint += other._fingerprint;
+        _fingerprint_valid = _fingerprint_valid && other._fingerprint_valid && _tree.size() == expected_size;
+        other._fingerprint = 0;
+        other._fingerprint_valid = true;
+        _update_boundary_nodes();
+        other._update_boundary_nodes();
+    }
+
+    // Packs all nodes into one block in van Emde Boas order; the set stays
+    // fully mutable afterwards. The block is held until its last node is
+    // erased, so after erasing most keys, call it again to release memory.
+    void optimize_layout() {
+        _tree.optimize_layout();
+        _update_boundary_nodes();
+    }
+
+    // Keeps a blocked Bloom filter in front of contains and find, so most
+    // misses are rejected after probing one cache line. It is updated on
+    // insert and rebuilt on the next lookup once erases have thinned it out.
+    // Needs std::less, so that keys equivalent under the comparator hash equally.
+    void enable_bloom_filter(double bits_per_key = 10) {
+        static_assert(_is_hashable, "the Bloom filter needs std::hash for the key type");
+        static_assert(_hash_matches_compare, "the Bloom filter needs std::less, custom comparators may disagree with std::hash");
+        _bloom._bits_per_key = bits_per_key;
+        _rebuild_bloom_filter();
+    }
+
+    void disable_bloom_filter() { _bloom = _BloomState(); }
+
+    // Estimated chance that a lookup of an absent key gets past the filter
+    double bloom_false_positive_rate() const { return _bloom._filter.false_positive_rate(); }
+
+    // Bytes held by the filter
+    size_type bloom_memory_usage() const { return _bloom._filter.memory_usage(); }
+
+    // Order-independent hash of the keys, kept up to date in O(1) per insert
+    // and erase; split and range erase defer it to the next call. Stable
+    // across processes that share the std::hash implementation; constant
+    // zero for keys without std::hash.
+    std::uint64_t fingerprint() const {
+        if (!_fingerprint_valid) {
+            _fingerprint = 0;
+            for (iterator it(_tree.root_address(), _begin_node); it != iterator(_tree.root_address(), _end_node); ++it) {
+                _fingerprint += _hash(*it);
+            }
+            _fingerprint_valid = true;
+        }
+        return _fingerprint;
+    }
+
+    bool contains(const _Tp& key) {
+        if (_bloom_rejects(key)) { return false; }
+        bool result = _tree.find(key) != nullptr;
+        _after_lookup();
+        return result;
+    }
+
+    // Lookup that never restructures the tree, even in splay mode, so
+    // concurrent readers can share it while no writer is active
+    bool peek(const key_type& key) const {
+        if (_bloom._bits_per_key > 0 && !_bloom._stale && !_bloom._filter.may_contain(_hash(key))) { return false; }
+        return _tree.find(key) != nullptr;
+    }
+
+    iterator find(const key_type& key) {
+        if (_bloom_rejects(key)) { return end(); }
+        node_ptr node = _tree.find(key);
+        _after_lookup();
+        return iterator(_tree.root_address(), node);
+    }
 
     void clear() {
         _tree.clear();
+        _bloom._stale = true;
+        _fingerprint = 0;
+        _fingerprint_valid = true;
         _begin_node = nullptr;
         _rbegin_node = nullptr;
     }
@@ -133,10 +316,116 @@ public:
 
     size_type size() { return _tree.size(); } // const
 
+    // With a positive ratio erase only marks keys dead; tombstones are
+    // compacted once they exceed that share of all nodes
+    void set_compaction_threshold(double ratio) {
+        _tree.set_compaction_threshold(ratio);
+        _update_boundary_nodes();
+    }
+
+    // Tombstones removed per erase once over the threshold, zero for a full pass
+    void set_compaction_step(size_type steps) { _tree.set_compaction_step(steps); }
+
+    void compact() {
+        _tree.compact();
+        _update_boundary_nodes();
+    }
+
+    size_type compact(size_type steps) {
+        size_type left = _tree.compact(steps);
+        _update_boundary_nodes();
+        return left;
+    }
+
+    size_type tombstones() const { return _tree.tombstones(); }
+
+    // Combines the keys in [lo, hi) in key order in O(height), using the
+    // subtree summaries the nodes keep up to date on every change
+    summary_type aggregate(const key_type& lo, const key_type& hi) const {
+        static_assert(!std::is_same_v<aggregate_type, no_aggregate>, "the set has no aggregate policy");
+        return _tree.aggregate(lo, hi);
+    }
+
+    summary_type aggregate() const {
+        static_assert(!std::is_same_v<aggregate_type, no_aggregate>, "the set has no aggregate policy");
+        return _tree.aggregate();
+    }
+
 private:
     tree_type _tree;
 
     node_ptr _begin_node;
     node_ptr _rbegin_node;
     node_ptr _end_node = nullptr; //
+
+    struct _BloomState {
+        BloomFilter _filter;
+        double      _bits_per_key = 0;  // zero while the filter is disabled
+        size_type   _capacity = 0;      // keys the filter was sized for, with headroom
+        size_type   _erased = 0;        // erases since the last rebuild
+        bool        _stale = false;     // keys were added without being hashed in
+    };
+
+    _BloomState _bloom;
+
+    mutable std::uint64_t   _fingerprint = 0;           // sum of the mixed key hashes
+    mutable bool            _fingerprint_valid = true;
+
+    static constexpr bool _is_hashable = requires (const key_type& key) { std::hash<key_type>()(key); };
+
+    // Under std::less, keys the comparator calls equal are equal and so hash
+    // equally; other comparators may merge keys that std::hash tells apart
+    static constexpr bool _hash_matches_compare =
+        std::is_same_v<key_compare, std::less<key_type>> || std::is_same_v<key_compare, std::less<>>;
+
+    static BloomFilter::hash_type _hash(const key_type& key) {
+        if constexpr (_is_hashable) { return BloomFilter::mix(std::hash<key_type>()(key)); }
+        else { return 0; }
+    }
+
+    void _rebuild_bloom_filter() {
+        _bloom._capacity = size() + size() / 2;
+        _bloom._filter.reset(_bloom._capacity, _bloom._bits_per_key);
+        for (auto it = begin(); it != end(); ++it) {
+            _bloom._filter.insert(_hash(*it));
+        }
+        _bloom._erased = 0;
+        _bloom._stale = false;
+    }
+
+    // Outgrowing the sizing would push the false positive rate up, so the
+    // filter is rebuilt at the next lookup instead
+    void _bloom_insert(const key_type& key) {
+        if (_bloom._bits_per_key == 0 || _bloom._stale) { return; }
+        if (size() > _bloom._capacity) { _bloom._stale = true; }
+        else { _bloom._filter.insert(_hash(key)); }
+    }
+
+    void _bloom_erase(size_type count) { _bloom._erased += count; }
+
+    bool _bloom_rejects(const key_type& key) {
+        if (_bloom._bits_per_key == 0) { return false; }
+        if (_bloom._stale || _bloom._erased > size()) { _rebuild_bloom_filter(); }
+        return !_bloom._filter.may_contain(_hash(key));
+    }
+
+    explicit Set(tree_type&& tree)
+        : _tree(std::move(tree)), _end_node(nullptr)
+    { _update_boundary_nodes(); }
+
+    // Splaying reshapes the tree, which moves the preorder and postorder ends
+    void _after_lookup() {
+        if constexpr (std::is_same_v<shape_tag, tree_shape_traits::splay_shape_tag>
+            && !std::is_same_v<order_tag, iterator_order_traits::inorder_iterator_tag>) {
+            _update_boundary_nodes();
+        }
+    }
+
+    // Boundary nodes skip tombstones left by lazy erase
+    void _update_boundary_nodes() {
+        _begin_node = _find_begin_node(_tree.root(), order_tag());
+        _rbegin_node = _find_rbegin_node(_tree.root(), order_tag());
+        if (_begin_node != nullptr && _begin_node->_dead) { _begin_node = (++iterator(_tree.root_address(), _begin_node)).node(); }
+        if (_rbegin_node != nullptr && _rbegin_node->_dead) { _rbegin_node = (--iterator(_tree.root_address(), _rbegin_node)).node(); }
+    }
 };
\ No newline at end of file
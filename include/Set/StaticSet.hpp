@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include "declarations.hpp"
+
+// Immutable set of N keys built entirely at compile time. Keys are kept
+// sorted for iteration and additionally laid out in Eytzinger (BFS) order,
+// so a lookup is a fixed-depth descent over one flat array with no branches
+// on the comparison result.
+
+template <typename _Tp, std::size_t _N, typename _Compare>
+class StaticSet {
+public:
+    typedef _Tp             key_type;
+    typedef key_type        value_type;
+    typedef _Compare        key_compare;
+    typedef std::size_t     size_type;
+
+    typedef const key_type*     iterator;
+    typedef const key_type*     const_iterator;
+
+    constexpr StaticSet(const std::array<key_type, _N>& keys)
+        : _keys(keys), _layout(), _rank(), _less()
+    {
+        std::sort(_keys.begin(), _keys.end(), _less);
+        for (size_type i = 1; i < _N; i++) {
+            if (!_less(_keys[i - 1], _keys[i])) { throw std::invalid_argument("StaticSet keys must be unique"); }
+        }
+
+        size_type next = 0;
+        _build(1, next);
+    }
+
+    constexpr iterator begin() const { return _keys.data(); }
+
+    constexpr iterator end() const { return _keys.data() + _N; }
+
+    constexpr const_iterator cbegin() const { return begin(); }
+
+    constexpr const_iterator cend() const { return end(); }
+
+    constexpr bool contains(const key_type& key) const {
+        size_type i = _lower_bound(key);
+        return i != 0 && !_less(key, _layout[i - 1]);
+    }
+
+    constexpr iterator find(const key_type& key) const {
+        size_type i = _lower_bound(key);
+        if (i == 0 || _less(key, _layout[i - 1])) { return end(); }
+        return _keys.data() + _rank[i - 1];
+    }
+
+    constexpr bool empty() const { return _N == 0; }
+
+    constexpr size_type size() const { return _N; }
+
+private:
+    std::array<key_type, _N>    _keys;      // sorted order
+    std::array<key_type, _N>    _layout;    // Eytzinger order, node i at [i - 1]
+    std::array<size_type, _N>   _rank;      // position of _layout[i] in _keys
+    key_compare                 _less;
+
+    // In-order walk of the implicit tree hands out sorted keys one by one
+    constexpr void _build(size_type node, size_type& next) {
+        if (node > _N) { return; }
+        _build(2 * node, next);
+        _layout[node - 1] = _keys[next];
+        _rank[node - 1] = next++;
+        _build(2 * node + 1, next);
+    }
+
+    // 1-based Eytzinger index of the first key not less than key, 0 if none.
+    // The descent always runs to a leaf; the trailing right turns are then
+    // undone to recover the last node where the path went left.
+    constexpr size_type _lower_bound(const key_type& key) const {
+        size_type i = 1;
+        while (i <= _N) {
+            i = 2 * i + static_cast<size_type>(_less(_layout[i - 1], key));
+        }
+        return i >> (std::countr_one(i) + 1);
+    }
+};
+
+template <typename _Tp, std::size_t _N>
+StaticSet(const std::array<_Tp, _N>&) -> StaticSet<_Tp, _N>;
+
+template <typename _Tp, typename... _Args>
+constexpr StaticSet<_Tp, sizeof...(_Args)> make_static_set(const _Args&... keys)
+    { return StaticSet<_Tp, sizeof...(_Args)>(std::array<_Tp, sizeof...(_Args)>{ _Tp(keys)... }); }
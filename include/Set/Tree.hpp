@@ -1,15 +1,21 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <iostream>
+#include <memory>
 #include "declarations.hpp"
 #include "Node.hpp"
+#include "NodePool.hpp"
 #include <vector>
 
 template <
     typename _Tp,
     typename _TreeNode,
     typename _Compare,
-    typename _Allocator
+    typename _Allocator,
+    std::size_t _InlineNodes,
+    typename _ShapeTag
 >
 class Tree {
 public:
@@ -19,92 +25,376 @@ public:
     typedef _TreeNode*      pointer;
     typedef std::size_t     size_type;
     typedef typename std::allocator_traits<_Allocator>::template rebind_alloc<node_type> allocator_type;
+    typedef NodePool<node_type, _InlineNodes> pool_type;
+    typedef NodeBlock<node_type>    block_type;
+    typedef _ShapeTag       shape_tag;
+    typedef typename node_type::aggregate_type  aggregate_type;
+    typedef typename node_type::summary_type    summary_type;
 
     // Constructor
     Tree() 
-        :   _allocator  (), 
+        :   _root       (nullptr),
             _less       (),
             _size       (0),
-            _root       (nullptr)
+            _allocator  (),
+            _pool       (),
+            _blocks     (),
+            _max_dead_ratio     (0),
+            _compaction_step    (0)
     {}
 
     // Copy constructor
     Tree(const Tree& other) 
-        :   _root(_copy_subtree(other._root)),
+        :   _root(nullptr),
             _less(),
+            _size(other._size),
             _allocator(),
-            _size(other._size)
-    {}
+            _pool(),
+            _blocks(),
+            _max_dead_ratio(other._max_dead_ratio),
+            _compaction_step(other._compaction_step)
+    { _root = _copy_subtree(other._root, nullptr); }
 
     // Move constructor
     Tree(Tree&& other) 
-        :   _allocator(std::move(other._allocator)),
+        :   _root(std::move(other._root)),
             _less(std::move(other._less)), 
             _size(std::move(other._size)), 
-            _root(std::move(other._root))
-    {}
+            _allocator(std::move(other._allocator)),
+            _pool(),
+            _blocks(std::move(other._blocks)),
+            _max_dead_ratio(other._max_dead_ratio),
+            _compaction_step(other._compaction_step)
+    {
+        other._root = nullptr;
+        other._size = 0;
+        _adopt_inline_nodes(other);
+    }
 
     // Copy assigment
     Tree& operator=(const Tree& other) {
-        _root = _copy_subtree(other._root),
+        if (this == &other) { return *this; }
+        clear();
+        _root = _copy_subtree(other._root, nullptr);
         _size = other._size;
+        _max_dead_ratio = other._max_dead_ratio;
+        _compaction_step = other._compaction_step;
 
         return *this;
     }
 
     // Move assigment
     Tree& operator=(Tree&& other) {
+        if (this == &other) { return *this; }
+        clear();
         _allocator = std::move(other._allocator);
         _less = std::move(other._less); 
         _size = std::move(other._size);
         _root = std::move(other._root);
+        _blocks = std::move(other._blocks);
+        _max_dead_ratio = other._max_dead_ratio;
+        _compaction_step = other._compaction_step;
+
+        other._root = nullptr;
+        other._size = 0;
+        _adopt_inline_nodes(other);
 
         return *this;
     }
 
-    bool operator==(const Tree& other) { 
+    // Walks both trees in key order side by side
+    bool operator==(const Tree& other) const { 
         if (_size != other.size()) { return false; }
-        return _compare_with(_root, other); 
+
+        pointer node = _next_live(nullptr);
+        pointer other_node = other._next_live(nullptr);
+        while (node != nullptr && other_node != nullptr) {
+            if (_less(node->_key, other_node->_key) || _less(other_node->_key, node->_key)) { return false; }
+            node = _next_live(node);
+            other_node = other._next_live(other_node);
+        }
+        return true;
     }
 
-    bool operator!=(const Tree& other) { return !((*this) == other); }
+    bool operator!=(const Tree& other) const { return !((*this) == other); }
 
-    void clear() { _clear_subtree(_root); }
+    void clear() {
+        _clear_subtree(_root);
+        _root = nullptr;
+        _size = 0;
+    }
 
     ~Tree() { clear(); }
 
     pointer root() const { return _root; }
 
-    bool empty() const { return _root == nullptr; }
+    // Stays valid while the root node changes, for iterators to follow
+    const pointer* root_address() const { return &_root; }
+
+    bool empty() const { return _size == 0; }
 
     size_type size() const { return _size; }
 
-    pointer insert(const key_type& key) { return _insert_to_subtree(_root, key); }
+    template <typename _Key>
+    pointer insert(_Key&& key) {
+        pointer node = _insert_to_subtree(_root, std::forward<_Key>(key));
+        _adjust(node, shape_tag());
+        return node;
+    }
+
+    bool remove(const key_type& key) {
+        pointer node = _find(_root, key);
+        if (node == nullptr) { return false; }
+
+        remove(node);
+        return true;
+    }
+
+    // Erases a live node of this tree without searching for it
+    void remove(pointer node) {
+        if (_max_dead_ratio > 0) { _mark_dead(node); }
+        else { _unlink_node(node); }
+    }
+
+    size_type tombstones() const { return _subtree_tombstones(_root); }
 
-    bool remove(const key_type& key) { return _remove(key); }
+    // A positive ratio makes remove only mark nodes dead; once tombstones
+    // exceed that share of all nodes they are compacted. Zero restores
+    // immediate removal.
+    void set_compaction_threshold(double ratio) {
+        _max_dead_ratio = ratio;
+        if (_max_dead_ratio <= 0) { compact(); }
+    }
+
+    // Tombstones unlinked per remove once over the threshold; zero means a
+    // full compaction pass instead
+    void set_compaction_step(size_type steps) { _compaction_step = steps; }
+
+    // Drops every tombstone and rebuilds the live nodes into a balanced shape
+    void compact() {
+        if (tombstones() == 0) { return; }
+
+        std::vector<pointer> live;
+        live.reserve(_size);
+        _collect_live(_root, live);
+        _root = _build_balanced(live, 0, live.size(), nullptr);
+    }
+
+    // Unlinks at most steps tombstones, returns how many are left
+    size_type compact(size_type steps) {
+        while (steps > 0 && tombstones() > 0) {
+            pointer node = _root;
+            while (!node->_dead) {
+                node = (_subtree_tombstones(node->_left) > 0) ? node->_left : node->_right;
+            }
+            _unlink_node(node);
+            steps--;
+        }
+        return tombstones();
+    }
 
-    pointer find(const key_type& key) { return _find(_root, key); }
+    // Lookups accept any type the comparator orders against key_type.
+    // May restructure the tree in splay mode.
+    template <typename _Key>
+    pointer find(const _Key& key) { return _find_and_adjust(key, shape_tag()); }
+
+    // Never restructures, so concurrent readers may share it
+    template <typename _Key>
+    const pointer find(const _Key& key) const { return _find(_root, key); }
+
+    // Moves the keys not less than key into the returned tree
+    Tree split(const key_type& key) {
+        Tree other;
+        pointer left;
+        pointer right;
+        _split_subtree(_root, key, left, right);
+
+        _root = left;
+        _size = _subtree_count(left);
+        other._root = right;
+        other._size = _subtree_count(right);
+        other._blocks = _blocks;
+        other._max_dead_ratio = _max_dead_ratio;
+        other._compaction_step = _compaction_step;
+
+        for (size_type i = 0; i < _pool.capacity(); i++) {
+            if (!_pool.used(i) || _less(_pool.node(i)->_key, key)) { continue; }
+            pointer old = _pool.node(i);
+            other._replace_node(old, other._allocate_node(std::move(old->_key)));
+            _deallocate_node(old);
+        }
+
+        return other;
+    }
+
+    // Moves every key of other into this tree. When one tree lies entirely
+    // below the other they are linked through a single node; overlapping
+    // ranges fall back to inserting other's keys one by one.
+    void join(Tree& other) {
+        if (this == &other || other._root == nullptr) { return; }
+        if (_root == nullptr) {
+            // Only the nodes move over; this tree keeps its own settings
+            double max_dead_ratio = _max_dead_ratio;
+            size_type compaction_step = _compaction_step;
+            *this = std::move(other);
+            _max_dead_ratio = max_dead_ratio;
+            _compaction_step = compaction_step;
+            return;
+        }
 
-    const pointer find(const key_type& key) const { return _find(_root, key); }
+        pointer min = _find_begin_node(_root, iterator_order_traits::inorder_iterator_tag());
+        pointer max = _find_rbegin_node(_root, iterator_order_traits::inorder_iterator_tag());
+        pointer other_min = _find_begin_node(other._root, iterator_order_traits::inorder_iterator_tag());
+        pointer other_max = _find_rbegin_node(other._root, iterator_order_traits::inorder_iterator_tag());
+
+        if (_less(max->_key, other_min->_key)) { _root = _join_subtrees(_root, other._root); }
+        else if (_less(other_max->_key, min->_key)) { _root = _join_subtrees(other._root, _root); }
+        else {
+            _insert_subtree(other._root);
+            other.clear();
+            return;
+        }
+
+        _size += other._size;
+        other._root = nullptr;
+        other._size = 0;
+        for (auto& block : other._blocks) {
+            if (std::find(_blocks.begin(), _blocks.end(), block) == _blocks.end()) { _blocks.push_back(block); }
+        }
+        other._blocks.clear();
+        _adopt_inline_nodes(other);
+    }
+
+    // Moves every node into one contiguous block in van Emde Boas order over
+    // a balanced shape, so a root-to-leaf descent touches O(log_B n) cache
+    // lines. Tombstones are dropped on the way; later inserts allocate
+    // nodes individually as usual.
+    //
+    // Slots freed by erase are not reused, and a block is released only
+    // with the last of its nodes, so erasing most keys afterwards keeps the
+    // whole block allocated. Calling optimize_layout() again repacks the
+    // survivors and releases the old block once no tree shares it.
+    void optimize_layout() {
+        if (_size == 0) {
+            clear();
+            return;
+        }
+
+        std::vector<pointer> old_nodes;
+        old_nodes.reserve(_size + tombstones());
+        for (pointer node = _find_begin_node(_root, iterator_order_traits::inorder_iterator_tag());
+                node != nullptr; node = _inorder_successor(node)) {
+            old_nodes.push_back(node);
+        }
+
+        std::vector<size_type> order;
+        order.reserve(_size);
+        _veb_order(0, _size, std::bit_width(_size), order);
+
+        std::vector<pointer> live;
+        live.reserve(_size);
+        for (pointer node : old_nodes) {
+            if (!node->_dead) { live.push_back(node); }
+        }
+
+        auto block = std::make_shared<block_type>();
+        block->_nodes = std::allocator_traits<allocator_type>::allocate(_allocator, _size);
+        block->_capacity = _size;
+        block->_live = _size;
+
+        std::vector<pointer> nodes(_size);
+        for (size_type position = 0; position < order.size(); position++) {
+            pointer node = block->_nodes + position;
+            std::allocator_traits<allocator_type>::construct(_allocator, node, std::move(live[order[position]]->_key));
+            nodes[order[position]] = node;
+        }
+
+        for (pointer node : old_nodes) { _deallocate_node(node); }
+        _blocks.push_back(block);
+        _root = _build_balanced(nodes, 0, nodes.size(), nullptr);
+    }
+
+    // Removes the keys in [lo, hi) by cutting them out as whole subtrees
+    size_type remove_range(const key_type& lo, const key_type& hi) { return _remove_range(&lo, &hi); }
+
+    // Removes the keys not less than lo
+    size_type remove_range(const key_type& lo) { return _remove_range(&lo, nullptr); }
+
+    // Folds the live keys in [lo, hi) with the node's aggregate policy
+    summary_type aggregate(const key_type& lo, const key_type& hi) const { return _fold(_root, &lo, &hi); }
+
+    summary_type aggregate() const { return _fold(_root, nullptr, nullptr); }
 
 private:
     pointer         _root;
     key_compare     _less;
     size_type       _size;
     allocator_type  _allocator;
+    [[no_unique_address]] pool_type _pool;
+    std::vector<std::shared_ptr<block_type>> _blocks;
+    double          _max_dead_ratio;
+    size_type       _compaction_step;
 
-    pointer _allocate_node(const key_type& key) {
-        pointer ptr = std::allocator_traits<allocator_type>::allocate(_allocator, 1);
-        std::allocator_traits<allocator_type>::construct(_allocator, ptr, key);
+    template <typename _Key>
+    pointer _allocate_node(_Key&& key) {
+        pointer ptr = _pool.allocate();
+        if (ptr == nullptr) { ptr = std::allocator_traits<allocator_type>::allocate(_allocator, 1); }
+        std::allocator_traits<allocator_type>::construct(_allocator, ptr, std::forward<_Key>(key));
 
         return ptr;
     }
 
     void _deallocate_node(pointer node) {
         std::allocator_traits<allocator_type>::destroy(_allocator, node);
+        if (_pool.owns(node)) {
+            _pool.deallocate(node);
+            return;
+        }
+
+        for (auto it = _blocks.begin(); it != _blocks.end(); ++it) {
+            block_type& block = **it;
+            if (!block.owns(node)) { continue; }
+            if (--block._live == 0) {
+                std::allocator_traits<allocator_type>::deallocate(_allocator, block._nodes, block._capacity);
+                block._nodes = nullptr;
+                _blocks.erase(it);
+            }
+            return;
+        }
+
         std::allocator_traits<allocator_type>::deallocate(_allocator, node, 1);
     }
 
+    // Puts node in place of old, taking over its links
+    void _replace_node(pointer old, pointer node) {
+        node->_count = old->_count;
+        node->_tombstones = old->_tombstones;
+        node->_dead = old->_dead;
+        node->_summary = old->_summary;
+        node->_left = old->_left;
+        node->_right = old->_right;
+        node->_parent = old->_parent;
+
+        if (_has_left_subtree(node)) { node->_left->_parent = node; }
+        if (_has_right_subtree(node)) { node->_right->_parent = node; }
+
+        if (node->_parent == nullptr) { _root = node; }
+        else if (node->_parent->_left == old) { node->_parent->_left = node; }
+        else { node->_parent->_right = node; }
+    }
+
+    // After stealing other's nodes, moves the ones living in its inline pool
+    // into storage owned by this tree
+    void _adopt_inline_nodes(Tree& other) {
+        for (size_type i = 0; i < other._pool.capacity(); i++) {
+            if (!other._pool.used(i)) { continue; }
+            pointer old = other._pool.node(i);
+            pointer node = _allocate_node(std::move(old->_key));
+            _replace_node(old, node);
+            other._deallocate_node(old);
+        }
+    }
+
     bool _is_valid_node(pointer node) const 
         { return ( node != nullptr ); }
 
@@ -122,10 +412,13 @@ private:
         }
     }
 
-    pointer _insert_to_subtree(pointer root, const key_type& key) {
-        if ( empty() ) {
-            _root = _allocate_node(key);
+    // The key is only moved into a newly allocated node
+    template <typename _Key>
+    pointer _insert_to_subtree(pointer root, _Key&& key) {
+        if ( _root == nullptr ) {
+            _root = _allocate_node(std::forward<_Key>(key));
             _size++;
+            _update_node(_root);
             return _root;
         }
         pointer node = root;
@@ -133,113 +426,347 @@ private:
             if (_less(key, node->_key)) {
                 if (_has_left_subtree(node)) { node = node->_left; } 
                 else { 
-                    pointer ptr = _allocate_node(key);
+                    pointer ptr = _allocate_node(std::forward<_Key>(key));
                     node->_left = ptr;
                     _size++;
 
                     ptr->_parent = node;
+                    _update_upward(ptr);
                     return ptr;
                 }
             } else if (_less(node->_key, key)) {
                 if (_has_right_subtree(node)) { node = node->_right; } 
                 else {
-                    pointer ptr = _allocate_node(key);
+                    pointer ptr = _allocate_node(std::forward<_Key>(key));
                     node->_right = ptr;
                     _size++;
 
                     ptr->_parent = node;
+                    _update_upward(ptr);
                     return ptr;
                 }
-            } else { return node; }
+            } else {
+                if (node->_dead) {
+                    node->_dead = false;
+                    _size++;
+                    _update_upward(node);
+                }
+                return node;
+            }
         }
 
         return nullptr;
     }
 
-    pointer _remove_from_subtree(pointer node, pointer parent, int key) {
-        if (!_is_valid_node(node)) { return nullptr; }
-
-        if      (_less(node->_key, key))    {node->_right = _remove_from_subtree(node->_right, node, key); }
-        else if (_less(key, node->_key))    {node->_left = _remove_from_subtree(node->_left, node, key); } 
-        else    {
-            if (!_has_left_subtree(node) && !_has_right_subtree(node)) {
-                // None
-                _deallocate_node(node);
-                _size--;
+    template <typename _Key>
+    pointer _find(pointer root, const _Key& key) const {
+        pointer node = root;
+        while (node != nullptr) {
+            if (_less(node->_key, key)) { node = node->_right; } 
+            else if (_less(key, node->_key)) { node = node->_left; } 
+            else { return node->_dead ? nullptr : node; }
+        }
 
-                return nullptr;
+        return nullptr;
+    }
 
-            } else if (!_has_left_subtree(node) && _has_right_subtree(node)) {
-                // Only right
-                pointer right_subtree = node->_right;
-                _deallocate_node(node);
-                _size--;
-                
-                right_subtree->_parent = parent;
-                return right_subtree;
+    pointer _copy_subtree(pointer other_node, pointer parent) {
+        pointer node = nullptr;
+        if (_is_valid_node(other_node)) {
+            node = _allocate_node(other_node->_key);
+            node->_parent = parent;
+            node->_left = _copy_subtree(other_node->_left, node);
+            node->_right = _copy_subtree(other_node->_right, node);
+            node->_dead = other_node->_dead;
+            _update_node(node);
+        }
+        return node;
+    }
 
-            } else if (_has_left_subtree(node) && !_has_right_subtree(node)) {
-                // Only left
-                pointer left_subtree = node->_left;
-                _deallocate_node(node);
-                _size--;
+    void _mark_dead(pointer node) {
+        node->_dead = true;
+        _size--;
+        _update_upward(node);
 
-                left_subtree->_parent = parent;
-                return left_subtree;
+        if (tombstones() > _max_dead_ratio * (_size + tombstones())) {
+            if (_compaction_step == 0) { compact(); }
+            else { compact(_compaction_step); }
+        }
+    }
 
-            } else if (_has_left_subtree(node) && _has_right_subtree(node)) {
-                // Both
+    // Splices node out by relinking its in-order predecessor into its place.
+    // Keys never move between nodes, so other nodes stay where they are.
+    void _unlink_node(pointer node) {
+        pointer parent = node->_parent;
+        pointer child;
+        pointer fix;
+
+        if (!_has_left_subtree(node) || !_has_right_subtree(node)) {
+            child = _has_left_subtree(node) ? node->_left : node->_right;
+            fix = parent;
+        } else {
+            child = _find_rbegin_node(node->_left, iterator_order_traits::inorder_iterator_tag());
+            if (child->_parent == node) {
+                fix = child;
+            } else {
+                fix = child->_parent;
+                fix->_right = child->_left;
+                if (_has_left_subtree(child)) { child->_left->_parent = fix; }
+                child->_left = node->_left;
+                child->_left->_parent = child;
+            }
+            child->_right = node->_right;
+            child->_right->_parent = child;
+        }
 
-                pointer successor = node->_left;
+        if (child != nullptr) { child->_parent = parent; }
+        if (parent == nullptr) { _root = child; }
+        else if (parent->_left == node) { parent->_left = child; }
+        else { parent->_right = child; }
 
-                while (_has_right_subtree(successor)) {
-                    successor = successor->_right;
-                }
+        if (!node->_dead) { _size--; }
+        _deallocate_node(node);
+        _update_upward(fix);
+    }
 
-                node->_key = successor->_key;
-                node->_left = _remove_from_subtree(node->_left, node, successor->_key);
-            }
+    void _collect_live(pointer node, std::vector<pointer>& live) {
+        if (_is_valid_node(node)) {
+            pointer right = node->_right;
+            _collect_live(node->_left, live);
+            if (node->_dead) { _deallocate_node(node); }
+            else { live.push_back(node); }
+            _collect_live(right, live);
         }
-        
+    }
+
+    pointer _build_balanced(const std::vector<pointer>& nodes, size_type first, size_type last, pointer parent) {
+        if (first == last) { return nullptr; }
+
+        size_type middle = first + (last - first) / 2;
+        pointer node = nodes[middle];
         node->_parent = parent;
+        node->_left = _build_balanced(nodes, first, middle, node);
+        node->_right = _build_balanced(nodes, middle + 1, last, node);
+        _update_node(node);
+
         return node;
     }
 
-    bool _remove(const key_type& key) {
-        if ( empty() ) { return false; }
-        size_type curr_size = size();
-        _root = _remove_from_subtree(_root, nullptr, key);
-        if (curr_size == size()) { return false; }
-        
-        return true;
+    void _adjust(pointer, tree_shape_traits::static_shape_tag) {}
+
+    void _adjust(pointer node, tree_shape_traits::splay_shape_tag) {
+        if (node != nullptr) { _splay(node); }
     }
 
-    pointer _find(pointer root, const key_type& key) const {
-        pointer node = root;
+    template <typename _Key>
+    pointer _find_and_adjust(const _Key& key, tree_shape_traits::static_shape_tag) { return _find(_root, key); }
+
+    // Misses splay the last node on the search path, keeping the amortised bound
+    template <typename _Key>
+    pointer _find_and_adjust(const _Key& key, tree_shape_traits::splay_shape_tag) {
+        pointer node = _root;
+        pointer last = nullptr;
         while (node != nullptr) {
-            if (_less(node->_key, key)) { node = node->_right; } 
-            else if (_less(key, node->_key)) { node = node->_left; } 
-            else { return node; }
+            last = node;
+            if (_less(node->_key, key)) { node = node->_right; }
+            else if (_less(key, node->_key)) { node = node->_left; }
+            else { break; }
         }
+        if (last != nullptr) { _splay(last); }
 
-        return nullptr;
+        return (node != nullptr && !node->_dead) ? node : nullptr;
     }
 
-    pointer _copy_subtree(pointer other_node) {
-        pointer node = nullptr;
-        if (_is_valid_node(other_node)) {
-            node = _allocate_node(other_node->_key);
-            node->_left = _copy_subtree(other_node->_left);
-            node->_right = _copy_subtree(other_node->_right);
+    // Lifts node above its parent, preserving the in-order sequence. Counters
+    // are derived from the old ones so only the subtree that changes sides is
+    // read, not the off-path siblings.
+    void _rotate(pointer node) {
+        pointer parent = node->_parent;
+        pointer grandparent = parent->_parent;
+        pointer inner;
+
+        if (parent->_left == node) {
+            inner = node->_right;
+            parent->_left = inner;
+            node->_right = parent;
+        } else {
+            inner = node->_left;
+            parent->_right = inner;
+            node->_left = parent;
+        }
+        if (inner != nullptr) { inner->_parent = parent; }
+        parent->_parent = node;
+        node->_parent = grandparent;
+
+        if (grandparent == nullptr) { _root = node; }
+        else if (grandparent->_left == parent) { grandparent->_left = node; }
+        else { grandparent->_right = node; }
+
+        size_type count = parent->_count;
+        size_type tombstones = parent->_tombstones;
+        parent->_count = count - node->_count + _subtree_count(inner);
+        parent->_tombstones = tombstones - node->_tombstones + _subtree_tombstones(inner);
+        node->_count = count;
+        node->_tombstones = tombstones;
+        _update_summary(parent);
+        _update_summary(node);
+    }
+
+    void _splay(pointer node) {
+        while (node->_parent != nullptr) {
+            pointer parent = node->_parent;
+            pointer grandparent = parent->_parent;
+            if (grandparent != nullptr) {
+                bool zig_zig = (grandparent->_left == parent) == (parent->_left == node);
+                _rotate(zig_zig ? parent : node);
+            }
+            _rotate(node);
         }
+    }
+
+    pointer _inorder_successor(pointer node) const {
+        if (_has_right_subtree(node)) { return _find_begin_node(node->_right, iterator_order_traits::inorder_iterator_tag()); }
+        while (node->_parent != nullptr && node->_parent->_right == node) { node = node->_parent; }
+        return node->_parent;
+    }
+
+    // Live node following node in key order; nullptr starts from the smallest
+    pointer _next_live(pointer node) const {
+        do {
+            node = (node == nullptr)
+                ? _find_begin_node(_root, iterator_order_traits::inorder_iterator_tag())
+                : _inorder_successor(node);
+        } while (node != nullptr && node->_dead);
         return node;
     }
 
-    bool _compare_with(pointer node, const Tree& other) {
+    // Appends the top `levels` levels of the balanced tree over the sorted
+    // positions [first, last) in van Emde Boas order: the upper half of the
+    // levels recursively, then each subtree hanging below it
+    static void _veb_order(size_type first, size_type last, size_type levels, std::vector<size_type>& order) {
+        if (first == last || levels == 0) { return; }
+        if (levels == 1) {
+            order.push_back(first + (last - first) / 2);
+            return;
+        }
+
+        size_type top = levels / 2;
+        _veb_order(first, last, top, order);
+        _veb_order_below(first, last, top, levels - top, order);
+    }
+
+    static void _veb_order_below(size_type first, size_type last, size_type depth, size_type levels, std::vector<size_type>& order) {
+        if (first == last) { return; }
+        if (depth == 0) {
+            _veb_order(first, last, levels, order);
+            return;
+        }
+
+        size_type middle = first + (last - first) / 2;
+        _veb_order_below(first, middle, depth - 1, levels, order);
+        _veb_order_below(middle + 1, last, depth - 1, levels, order);
+    }
+
+    void _update_upward(pointer node) {
+        while (node != nullptr) {
+            _update_node(node);
+            node = node->_parent;
+        }
+    }
+
+    // Cuts the subtree at node along the search path for key into keys less
+    // than key (left) and the rest (right), touching only path nodes
+    void _split_subtree(pointer node, const key_type& key, pointer& left, pointer& right) {
+        pointer* left_hook = &left;
+        pointer* right_hook = &right;
+        pointer left_parent = nullptr;
+        pointer right_parent = nullptr;
+
+        while (node != nullptr) {
+            if (_less(node->_key, key)) {
+                *left_hook = node;
+                node->_parent = left_parent;
+                left_parent = node;
+                left_hook = &node->_right;
+                node = node->_right;
+            } else {
+                *right_hook = node;
+                node->_parent = right_parent;
+                right_parent = node;
+                right_hook = &node->_left;
+                node = node->_left;
+            }
+        }
+        *left_hook = nullptr;
+        *right_hook = nullptr;
+
+        _update_upward(left_parent);
+        _update_upward(right_parent);
+    }
+
+    // Links two parentless subtrees where every key of left is less than
+    // every key of right, using the maximum of left as the new root
+    pointer _join_subtrees(pointer left, pointer right) {
+        if (left == nullptr) { return right; }
+        if (right == nullptr) { return left; }
+
+        pointer middle = _find_rbegin_node(left, iterator_order_traits::inorder_iterator_tag());
+        pointer parent = middle->_parent;
+        if (parent != nullptr) {
+            parent->_right = middle->_left;
+            if (_has_left_subtree(middle)) { middle->_left->_parent = parent; }
+            _update_upward(parent);
+        } else {
+            left = middle->_left;
+        }
+
+        middle->_left = left;
+        middle->_right = right;
+        middle->_parent = nullptr;
+        if (left != nullptr) { left->_parent = middle; }
+        right->_parent = middle;
+        _update_node(middle);
+
+        return middle;
+    }
+
+    // Null bounds are open
+    size_type _remove_range(const key_type* lo, const key_type* hi) {
+        pointer left = nullptr;
+        pointer middle = _root;
+        pointer right = nullptr;
+        if (lo != nullptr) { _split_subtree(middle, *lo, left, middle); }
+        if (hi != nullptr) { _split_subtree(middle, *hi, middle, right); }
+
+        size_type removed = _subtree_count(middle);
+        _clear_subtree(middle);
+        _root = _join_subtrees(left, right);
+        _size -= removed;
+
+        return removed;
+    }
+
+    // Null bounds are open. Once a node falls inside the range, its left
+    // subtree is bounded only below and its right subtree only above, so each
+    // side continues down a single path and takes whole subtree summaries.
+    summary_type _fold(pointer node, const key_type* lo, const key_type* hi) const {
+        if (node == nullptr) { return aggregate_type::identity(); }
+        if (lo == nullptr && hi == nullptr) { return node->_summary; }
+        if (lo != nullptr && _less(node->_key, *lo)) { return _fold(node->_right, lo, hi); }
+        if (hi != nullptr && !_less(node->_key, *hi)) { return _fold(node->_left, lo, hi); }
+
+        summary_type self = node->_dead ? aggregate_type::identity() : aggregate_type::lift(node->_key);
+        summary_type left = _fold(node->_left, lo, nullptr);
+        summary_type right = _fold(node->_right, nullptr, hi);
+        return aggregate_type::combine(aggregate_type::combine(left, self), right);
+    }
+
+    void _insert_subtree(pointer node) {
         if (_is_valid_node(node)) {
-            if (other.find(node->_key) == nullptr) { return false; }
-            return (_compare_with(node->_left, other) && _compare_with(node->_right, other));
+            if (!node->_dead) { insert(node->_key); }
+            _insert_subtree(node->_left);
+            _insert_subtree(node->_right);
         }
-        return true;
     }
+
 };
\ No newline at end of file
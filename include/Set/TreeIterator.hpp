@@ -3,19 +3,19 @@
 #include "declarations.hpp"
 #include "Node.hpp"
 
-template <typename _Tp, typename _OrderTag>
+template <typename _Tp, typename _OrderTag, typename _TreeNode>
 class TreeIterator {
 public:
     
     typedef _Tp                                             key_type;
     typedef _OrderTag                                       order_tag;
 
-    typedef Node<key_type>                                  node_type;
+    typedef _TreeNode                                       node_type;
     typedef node_type*                                      pointer;
     typedef node_type&                                      reference;
     typedef const node_type&                                const_reference;
 
-    typedef TreeIterator<key_type, order_tag>               iterator;
+    typedef TreeIterator<key_type, order_tag, node_type>    iterator;
     typedef iterator&                                       iterator_reference;
     typedef const iterator&                                 iterator_const_reference;
     typedef const iterator                                  const_iterator;
@@ -62,22 +62,22 @@ public:
         { return !((*this) == other); }
 
     iterator_reference operator++() {
-        _node = _next_node(order_tag());
+        _step_forward();
         return *this;
     }
 
     iterator_reference operator++(int) {
-        _node = _next_node(order_tag());
+        _step_forward();
         return *this;
     }
 
     iterator_reference operator--() {
-        _node = _prev_node(order_tag());
+        _step_backward();
         return *this;
     }
 
     iterator_reference operator--(int) {
-        _node = _prev_node(order_tag());
+        _step_backward();
         return *this;
     }
 
@@ -85,20 +85,34 @@ public:
 
     const key_type& operator*() const { return _node->_key; }
 
+    pointer node() const { return _node; }
+
     // template <typename> friend class Set;
 
-    TreeIterator(pointer root, pointer _node)
+    // root points at the tree's root field rather than copying it, so
+    // iterators survive erase and splay changing the root node
+    TreeIterator(const pointer* root, pointer _node)
         : _root(root), _node(_node)
     {}
 
 private:
-    pointer     _root;
-    pointer     _node;
+    const pointer*  _root;
+    pointer         _node;
 
     //  TreeIterator(pointer root, pointer _node)
     //     : _root(root), _node(_node)
     // {}
 
+    // Tombstones left by lazy erase are stepped over
+
+    void _step_forward() {
+        do { _node = _next_node(order_tag()); } while (_node != nullptr && _node->_dead);
+    }
+
+    void _step_backward() {
+        do { _node = _prev_node(order_tag()); } while (_node != nullptr && _node->_dead);
+    }
+
     pointer _next_node(iterator_order_traits::inorder_iterator_tag) { // const
         if (_node == nullptr) { exit(EXIT_FAILURE); }
         if (_has_right_subtree<key_type>(_node)) {
@@ -162,7 +176,7 @@ private:
     }
 
     pointer _prev_node(iterator_order_traits::inorder_iterator_tag) {
-        if (_node == nullptr) { return _find_rbegin_node<key_type>(_root, order_tag()); }
+        if (_node == nullptr) { return _find_rbegin_node<key_type>(*_root, order_tag()); }
         if (_has_left_subtree<key_type>(_node)) {
             pointer current = _node->_left;
             while (_has_right_subtree<key_type>(current)) { current = current->_right; }
@@ -182,7 +196,7 @@ private:
 
     pointer _prev_node(iterator_order_traits::preorder_iterator_tag) {
         if ( _node == nullptr ) 
-            { return _find_rbegin_node<key_type>(_root, order_tag()); }
+            { return _find_rbegin_node<key_type>(*_root, order_tag()); }
         
         pointer current = _node;
         pointer parent = current->_parent;
@@ -199,7 +213,7 @@ private:
     }
 
     pointer _prev_node(iterator_order_traits::postorder_iterator_tag) {
-        if (_node == nullptr) { return _find_rbegin_node<key_type>(_root, order_tag()); }
+        if (_node == nullptr) { return _find_rbegin_node<key_type>(*_root, order_tag()); }
         pointer current = _node;
         if (current->_right)
             return current->_right;
@@ -219,8 +233,8 @@ private:
 };
 
 
-template<class _Tp>
-struct std::iterator_traits<TreeIterator<_Tp, iterator_order_traits::inorder_iterator_tag> > {
+template<class _Tp, class _TreeNode>
+struct std::iterator_traits<TreeIterator<_Tp, iterator_order_traits::inorder_iterator_tag, _TreeNode> > {
     typedef  std::size_t                            difference_type;
     typedef  _Tp                                    key_type;
     typedef  _Tp                                    value_type;
@@ -229,8 +243,8 @@ struct std::iterator_traits<TreeIterator<_Tp, iterator_order_traits::inorder_ite
     typedef  std::bidirectional_iterator_tag        iterator_category;
 };
 
-template<class _Tp>
-struct std::iterator_traits<TreeIterator<_Tp, iterator_order_traits::preorder_iterator_tag> > {
+template<class _Tp, class _TreeNode>
+struct std::iterator_traits<TreeIterator<_Tp, iterator_order_traits::preorder_iterator_tag, _TreeNode> > {
     typedef  std::size_t                            difference_type;
     typedef  _Tp                                    key_type;
     typedef  _Tp                                    value_type;
@@ -239,8 +253,8 @@ struct std::iterator_traits<TreeIterator<_Tp, iterator_order_traits::preorder_it
     typedef  std::bidirectional_iterator_tag        iterator_category;
 };
 
-template<class _Tp>
-struct std::iterator_traits<TreeIterator<_Tp, iterator_order_traits::postorder_iterator_tag> > {
+template<class _Tp, class _TreeNode>
+struct std::iterator_traits<TreeIterator<_Tp, iterator_order_traits::postorder_iterator_tag, _TreeNode> > {
     typedef  std::size_t                            difference_type;
     typedef  _Tp                                    key_type;
     typedef  _Tp                                    value_type;
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <iterator>
 
 // Iterator order traits
@@ -8,8 +9,21 @@ struct iterator_order_traits {
     struct postorder_iterator_tag {};
 };
 
+// Tree shape traits
+struct tree_shape_traits {
+    struct static_shape_tag {};     // shape depends only on the order of updates
+    struct splay_shape_tag {};      // accessed nodes are rotated up to the root
+};
+
+// Aggregate policies fold the keys of a subtree in key order. A policy
+// provides value_type, identity(), lift(key) and an associative
+// combine(left, right); no_aggregate keeps nothing.
+struct no_aggregate {
+    struct value_type {};
+};
+
 // Node
-template <typename _Tp>
+template <typename _Tp, typename _Aggregate = no_aggregate>
 struct Node;
 
 
@@ -18,12 +32,15 @@ template <
     typename _Tp, 
     typename _OrderTag = iterator_order_traits::inorder_iterator_tag,
     typename _Compare = std::less<_Tp>,
-    typename _Allocator = std::allocator<_Tp> 
+    typename _Allocator = std::allocator<_Tp>,
+    std::size_t _InlineCapacity = 0,
+    typename _ShapeTag = tree_shape_traits::static_shape_tag,
+    typename _Aggregate = no_aggregate
 >
 class Set;
 
 // TreeIterator
-template <typename _Tp, typename _NodeType>
+template <typename _Tp, typename _OrderTag, typename _TreeNode = Node<_Tp>>
 class TreeIterator;
 
 
@@ -32,7 +49,45 @@ template <
     typename _Tp,
     typename _TreeNode,
     typename _Compare,
-    typename _Allocator
+    typename _Allocator,
+    std::size_t _InlineNodes,
+    typename _ShapeTag
 >
 class Tree;
 
+// NodePool
+template <typename _TreeNode, std::size_t _N>
+class NodePool;
+
+// NodeBlock
+template <typename _TreeNode>
+struct NodeBlock;
+
+// PrefixSet
+template <std::size_t _BlockSize = 16>
+class PrefixSet;
+
+// PrefixSetIterator
+template <std::size_t _BlockSize>
+class PrefixSetIterator;
+
+// Map
+template <
+    typename _Key,
+    typename _Value,
+    typename _Compare = std::less<_Key>,
+    typename _Allocator = std::allocator<_Value>
+>
+class Map;
+
+// MapIterator
+template <typename _Key, typename _Value, typename _Compare, typename _Allocator>
+class MapIterator;
+
+// StaticSet
+template <
+    typename _Tp,
+    std::size_t _N,
+    typename _Compare = std::less<_Tp>
+>
+class StaticSet;
@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 #include <Set/Set.hpp>
+#include <Set/Map.hpp>
+#include <Set/PrefixSet.hpp>
+#include <Set/StaticSet.hpp>
+#include <algorithm>
+#include <cctype>
+#include <set>
+#include <string>
 #include <vector>
 
 TEST(BaseTestSuite, InsertTest) {
@@ -161,4 +168,668 @@ TEST(PostorderTestSuite, ReverseIteratorTest) {
     ASSERT_EQ(values[0], 5);
     ASSERT_EQ(values[1], 6);
     ASSERT_EQ(values[2], 3);
-}
\ No newline at end of file
+}
+
+TEST(PrefixSetTestSuite, InsertEraseTest) {
+    PrefixSet<4> s;
+    std::set<std::string> expected;
+    for (int i = 0; i < 200; i += 3) {
+        std::string key = "https://example.com/path/" + std::to_string(i);
+        ASSERT_TRUE(s.insert(key).second);
+        expected.insert(key);
+    }
+    ASSERT_FALSE(s.insert("https://example.com/path/3").second);
+
+    for (int i = 0; i < 200; i += 6) {
+        std::string key = "https://example.com/path/" + std::to_string(i);
+        ASSERT_TRUE(s.erase(key));
+        expected.erase(key);
+    }
+    ASSERT_FALSE(s.erase("https://example.com/path/0"));
+
+    ASSERT_EQ(s.size(), expected.size());
+    for (int i = 0; i < 200; i++) {
+        std::string key = "https://example.com/path/" + std::to_string(i);
+        ASSERT_EQ(s.contains(key), expected.count(key) == 1);
+    }
+    ASSERT_FALSE(s.contains("https://example.com/path"));
+    ASSERT_FALSE(s.contains("https://example.com/path/33/"));
+}
+
+TEST(PrefixSetTestSuite, IteratorTest) {
+    PrefixSet<4> s;
+    std::set<std::string> expected;
+    for (std::string key : {"/usr/lib", "/usr", "/usr/local/lib", "/var", "/usr/local", "/", "/usr/lib64", "/var/log", "/etc"}) {
+        s.insert(key);
+        expected.insert(key);
+    }
+
+    std::vector<std::string> values(s.begin(), s.end());
+    ASSERT_EQ(values, std::vector<std::string>(expected.begin(), expected.end()));
+
+    auto it = s.find("/usr/local");
+    ASSERT_EQ(*it, "/usr/local");
+    --it;
+    ASSERT_EQ(*it, "/usr/lib64");
+    ++it;
+    ++it;
+    ASSERT_EQ(*it, "/usr/local/lib");
+
+    it = s.end();
+    --it;
+    ASSERT_EQ(*it, "/var/log");
+}
+
+TEST(StaticSetTestSuite, CompileTimeLookupTest) {
+    static constexpr auto s = make_static_set<int>(17, 3, 42, 8, -5, 23, 11);
+
+    static_assert(s.size() == 7);
+    static_assert(s.contains(42));
+    static_assert(s.contains(-5));
+    static_assert(!s.contains(10));
+    static_assert(*s.find(23) == 23);
+    static_assert(s.find(100) == s.end());
+
+    std::vector<int> values(s.begin(), s.end());
+    ASSERT_EQ(values, std::vector<int>({-5, 3, 8, 11, 17, 23, 42}));
+    for (int key = -10; key < 50; key++) {
+        ASSERT_EQ(s.contains(key), std::find(values.begin(), values.end(), key) != values.end());
+    }
+}
+
+struct CountingAllocatorBase {
+    static inline std::size_t total_allocations = 0;   // across all rebound types
+};
+
+template <typename _Tp>
+struct CountingAllocator : CountingAllocatorBase {
+    typedef _Tp value_type;
+
+    static inline std::size_t allocations = 0;
+
+    CountingAllocator() = default;
+
+    template <typename _Up>
+    CountingAllocator(const CountingAllocator<_Up>&) {}
+
+    _Tp* allocate(std::size_t n) {
+        allocations++;
+        total_allocations++;
+        return std::allocator<_Tp>().allocate(n);
+    }
+
+    void deallocate(_Tp* ptr, std::size_t n) { std::allocator<_Tp>().deallocate(ptr, n); }
+};
+
+TEST(InlineStorageTestSuite, NoHeapWhileSmallTest) {
+    typedef Set<int, iterator_order_traits::inorder_iterator_tag, std::less<int>, CountingAllocator<int>, 4> SmallSet;
+    CountingAllocator<Node<int>>::allocations = 0;
+
+    SmallSet s;
+    for (int key : {5, 3, 6, 1}) { s.insert(key); }
+    ASSERT_EQ(CountingAllocator<Node<int>>::allocations, 0);
+
+    s.erase(3);
+    s.insert(2);
+    ASSERT_EQ(CountingAllocator<Node<int>>::allocations, 0);
+
+    for (int key : {9, 8, 7}) { s.insert(key); }
+    ASSERT_EQ(CountingAllocator<Node<int>>::allocations, 3);
+
+    std::vector<int> values(s.begin(), s.end());
+    ASSERT_EQ(values, std::vector<int>({1, 2, 5, 6, 7, 8, 9}));
+}
+
+TEST(InlineStorageTestSuite, CopyMoveTest) {
+    typedef Set<int, iterator_order_traits::inorder_iterator_tag, std::less<int>, std::allocator<int>, 4> SmallSet;
+    SmallSet s;
+    for (int key : {5, 3, 6, 1, 4, 8, 7}) { s.insert(key); }
+
+    SmallSet copy = s;
+    SmallSet moved = std::move(s);
+    ASSERT_TRUE(s.empty());
+    ASSERT_TRUE(copy == moved);
+
+    moved.erase(5);
+    std::vector<int> values(moved.begin(), moved.end());
+    ASSERT_EQ(values, std::vector<int>({1, 3, 4, 6, 7, 8}));
+
+    values.assign(copy.begin(), copy.end());
+    ASSERT_EQ(values, std::vector<int>({1, 3, 4, 5, 6, 7, 8}));
+}
+
+TEST(SplitJoinTestSuite, SplitJoinTest) {
+    Set<int> s;
+    for (int key : {50, 20, 80, 10, 30, 70, 90, 25, 35, 60}) { s.insert(key); }
+
+    Set<int> upper = s.split(30);
+    ASSERT_EQ(s.size(), 3);
+    ASSERT_EQ(upper.size(), 7);
+    ASSERT_EQ(std::vector<int>(s.begin(), s.end()), std::vector<int>({10, 20, 25}));
+    ASSERT_EQ(std::vector<int>(upper.begin(), upper.end()), std::vector<int>({30, 35, 50, 60, 70, 80, 90}));
+
+    Set<int> lower;
+    lower.insert(5);
+    lower.insert(1);
+    s.join(lower);
+    upper.join(s);
+    ASSERT_TRUE(lower.empty());
+    ASSERT_TRUE(s.empty());
+    ASSERT_EQ(upper.size(), 12);
+    ASSERT_EQ(std::vector<int>(upper.begin(), upper.end()), std::vector<int>({1, 5, 10, 20, 25, 30, 35, 50, 60, 70, 80, 90}));
+
+    Set<int> overlapping;
+    overlapping.insert(7);
+    overlapping.insert(100);
+    upper.join(overlapping);
+    ASSERT_EQ(upper.size(), 14);
+    ASSERT_TRUE(upper.contains(7));
+    ASSERT_TRUE(upper.contains(100));
+}
+
+TEST(SplitJoinTestSuite, RangeEraseTest) {
+    typedef Set<int, iterator_order_traits::inorder_iterator_tag, std::less<int>, std::allocator<int>, 8> SmallSet;
+    SmallSet s;
+    for (int key : {50, 20, 80, 10, 30, 70, 90, 25, 35, 60, 85, 95}) { s.insert(key); }
+
+    ASSERT_EQ(s.erase_range(25, 70), 5);
+    ASSERT_EQ(s.size(), 7);
+    ASSERT_EQ(std::vector<int>(s.begin(), s.end()), std::vector<int>({10, 20, 70, 80, 85, 90, 95}));
+
+    auto first = s.find(80);
+    auto last = s.find(95);
+    auto it = s.erase(first, last);
+    ASSERT_EQ(*it, 95);
+    ASSERT_EQ(std::vector<int>(s.begin(), s.end()), std::vector<int>({10, 20, 70, 95}));
+
+    s.erase(s.find(20), s.end());
+    ASSERT_EQ(std::vector<int>(s.begin(), s.end()), std::vector<int>({10}));
+
+    SmallSet upper = s.split(0);
+    ASSERT_TRUE(s.empty());
+    ASSERT_EQ(upper.size(), 1);
+}
+
+TEST(LazyEraseTestSuite, TombstoneTest) {
+    Set<int> s;
+    s.set_compaction_threshold(0.5);
+    for (int key : {50, 20, 80, 10, 30, 70, 90}) { s.insert(key); }
+
+    ASSERT_TRUE(s.erase(10));
+    ASSERT_TRUE(s.erase(50));
+    ASSERT_FALSE(s.erase(50));
+    ASSERT_EQ(s.size(), 5);
+    ASSERT_EQ(s.tombstones(), 2);
+    ASSERT_FALSE(s.contains(50));
+    ASSERT_EQ(std::vector<int>(s.begin(), s.end()), std::vector<int>({20, 30, 70, 80, 90}));
+
+    auto it = s.end();
+    --it;
+    --it;
+    --it;
+    ASSERT_EQ(*it, 70);
+    --it;
+    ASSERT_EQ(*it, 30);
+
+    ASSERT_TRUE(s.insert(50).second);
+    ASSERT_EQ(s.tombstones(), 1);
+    ASSERT_TRUE(s.contains(50));
+
+    ASSERT_EQ(s.compact(1), 0);
+    ASSERT_EQ(std::vector<int>(s.begin(), s.end()), std::vector<int>({20, 30, 50, 70, 80, 90}));
+}
+
+TEST(LazyEraseTestSuite, CompactionThresholdTest) {
+    Set<int> s;
+    s.set_compaction_threshold(0.25);
+    for (int key = 0; key < 16; key++) { s.insert(key); }
+
+    for (int key = 0; key < 4; key++) { s.erase(key); }
+    ASSERT_EQ(s.tombstones(), 4);
+
+    s.erase(4);
+    ASSERT_EQ(s.tombstones(), 0);
+    ASSERT_EQ(s.size(), 11);
+    ASSERT_EQ(*s.begin(), 5);
+
+    s.erase(5);
+    s.set_compaction_threshold(0);
+    ASSERT_EQ(s.tombstones(), 0);
+    ASSERT_TRUE(s.erase(6));
+    ASSERT_EQ(s.size(), 9);
+}
+
+TEST(LazyEraseTestSuite, SplitJoinKeepThresholdTest) {
+    Set<int> a;
+    Set<int> b;
+    a.set_compaction_threshold(0.9);
+    for (int key = 0; key < 8; key++) { b.insert(key); }
+
+    a.join(b);
+    ASSERT_TRUE(a.erase(3));
+    ASSERT_EQ(a.tombstones(), 1);
+
+    Set<int> upper = a.split(5);
+    ASSERT_TRUE(upper.erase(6));
+    ASSERT_EQ(upper.tombstones(), 1);
+    ASSERT_EQ(std::vector<int>(upper.begin(), upper.end()), std::vector<int>({5, 7}));
+}
+
+TEST(BaseTestSuite, EraseKeepsIteratorsTest) {
+    Set<std::string> s;
+    for (std::string key : {"m", "f", "t", "c", "h", "p", "w", "g", "k"}) { s.insert(key); }
+
+    std::vector<const std::string*> addresses;
+    for (auto it = s.begin(); it != s.end(); ++it) { addresses.push_back(&*it); }
+
+    ASSERT_TRUE(s.erase("f"));
+    ASSERT_TRUE(s.erase("m"));
+
+    std::vector<std::string> values;
+    std::vector<const std::string*> remaining;
+    for (auto it = s.begin(); it != s.end(); ++it) {
+        values.push_back(*it);
+        remaining.push_back(&*it);
+    }
+    ASSERT_EQ(values, std::vector<std::string>({"c", "g", "h", "k", "p", "t", "w"}));
+    for (const std::string* address : remaining) {
+        ASSERT_NE(std::find(addresses.begin(), addresses.end(), address), addresses.end());
+    }
+
+    auto it = s.erase(s.find("k"));
+    ASSERT_EQ(*it, "p");
+    it = s.erase(s.find("w"));
+    ASSERT_TRUE(it == s.end());
+    ASSERT_EQ(s.size(), 5);
+}
+
+TEST(BaseTestSuite, IterateAfterRootEraseTest) {
+    Set<int> s;
+    for (int key : {5, 3, 8, 1, 4, 7, 9}) { s.insert(key); }
+
+    auto it = s.find(8);
+    ASSERT_TRUE(s.erase(5));
+    std::vector<int> values;
+    for (; it != s.end(); ++it) { values.push_back(*it); }
+    ASSERT_EQ(values, std::vector<int>({8, 9}));
+
+    it = s.end();
+    ASSERT_TRUE(s.erase(4));
+    --it;
+    ASSERT_EQ(*it, 9);
+}
+
+TEST(SplayTestSuite, AccessMovesToRootTest) {
+    typedef Set<int, iterator_order_traits::preorder_iterator_tag, std::less<int>, std::allocator<int>, 0,
+        tree_shape_traits::splay_shape_tag> SplaySet;
+    SplaySet s;
+    for (int key = 1; key <= 7; key++) { s.insert(key); }
+    ASSERT_EQ(*s.begin(), 7);
+
+    ASSERT_TRUE(s.contains(3));
+    ASSERT_EQ(*s.begin(), 3);
+
+    ASSERT_TRUE(s.peek(5));
+    ASSERT_FALSE(s.peek(8));
+    ASSERT_EQ(*s.begin(), 3);
+
+    ASSERT_EQ(*s.find(6), 6);
+    ASSERT_EQ(*s.begin(), 6);
+
+    s.erase(6);
+    std::vector<int> values(s.begin(), s.end());
+    std::sort(values.begin(), values.end());
+    ASSERT_EQ(values, std::vector<int>({1, 2, 3, 4, 5, 7}));
+}
+
+TEST(SplayTestSuite, IterateWhileLookingUpTest) {
+    typedef Set<int, iterator_order_traits::inorder_iterator_tag, std::less<int>, std::allocator<int>, 0,
+        tree_shape_traits::splay_shape_tag> SplaySet;
+    SplaySet s;
+    for (int key = 0; key < 10; key++) { s.insert(key); }
+
+    std::vector<int> values;
+    for (auto it = s.begin(); it != s.end(); ++it) {
+        ASSERT_TRUE(s.contains(9 - *it));
+        ASSERT_FALSE(s.contains(*it + 20));
+        values.push_back(*it);
+    }
+    ASSERT_EQ(values, std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+    auto it = s.find(4);
+    s.insert(42);
+    ASSERT_EQ(*++it, 5);
+    it = s.end();
+    s.find(0);
+    ASSERT_EQ(*--it, 42);
+}
+
+TEST(LayoutTestSuite, OptimizeLayoutTest) {
+    Set<int> s;
+    for (int key = 0; key < 100; key++) { s.insert((key * 37) % 100); }
+    s.optimize_layout();
+
+    const int* low = &*s.begin();
+    const int* high = low;
+    for (auto it = s.begin(); it != s.end(); ++it) {
+        low = std::min<const int*>(low, &*it);
+        high = std::max<const int*>(high, &*it);
+    }
+    ASSERT_LT(reinterpret_cast<const char*>(high) - reinterpret_cast<const char*>(low), 100 * sizeof(Node<int>));
+
+    // The root of the balanced shape comes first in van Emde Boas order
+    ASSERT_EQ(&*s.find(50), low);
+
+    for (int key = 0; key < 100; key += 2) { s.erase(key); }
+    for (int key = 100; key < 110; key++) { s.insert(key); }
+    Set<int> upper = s.split(51);
+    ASSERT_EQ(s.size(), 25);
+    ASSERT_EQ(upper.size(), 35);
+    s.join(upper);
+
+    std::vector<int> values(s.begin(), s.end());
+    ASSERT_EQ(values.size(), 60);
+    ASSERT_EQ(values.front(), 1);
+    ASSERT_EQ(values.back(), 109);
+    ASSERT_TRUE(std::is_sorted(values.begin(), values.end()));
+}
+
+TEST(BloomFilterTestSuite, NegativeLookupTest) {
+    Set<int> s;
+    for (int key = 0; key < 2000; key += 2) { s.insert(key); }
+    s.enable_bloom_filter(10);
+    for (int key = 2000; key < 4000; key += 2) { s.insert(key); }
+
+    for (int key = 0; key < 4000; key += 2) { ASSERT_TRUE(s.contains(key)); }
+    ASSERT_GT(s.bloom_memory_usage(), 0);
+    ASSERT_LT(s.bloom_false_positive_rate(), 0.05);
+
+    for (int key = 0; key < 3000; key += 2) { s.erase(key); }
+    for (int key = 0; key < 3000; key++) { ASSERT_FALSE(s.contains(key)); }
+    for (int key = 3000; key < 4000; key += 2) {
+        ASSERT_TRUE(s.contains(key));
+        ASSERT_TRUE(s.peek(key));
+        ASSERT_EQ(*s.find(key), key);
+    }
+    ASSERT_LT(s.bloom_false_positive_rate(), 0.01);
+
+    Set<int> upper = s.split(3500);
+    ASSERT_TRUE(upper.contains(3500));
+    ASSERT_FALSE(s.contains(3500));
+    s.join(upper);
+    ASSERT_TRUE(s.contains(3998));
+
+    s.disable_bloom_filter();
+    ASSERT_EQ(s.bloom_memory_usage(), 0);
+    ASSERT_TRUE(s.contains(3000));
+}
+
+TEST(BloomFilterTestSuite, MovedFromSetTest) {
+    Set<int> a;
+    a.enable_bloom_filter();
+    a.insert(1);
+
+    Set<int> b(std::move(a));
+    a.insert(2);
+    ASSERT_TRUE(a.contains(2));
+    ASSERT_TRUE(b.contains(1));
+
+    b = std::move(a);
+    a.insert(3);
+    ASSERT_TRUE(a.contains(3));
+    ASSERT_TRUE(b.contains(2));
+    ASSERT_FALSE(b.contains(1));
+}
+
+TEST(BaseTestSuite, SelfMoveAssignmentTest) {
+    Set<int> s;
+    for (int key = 0; key < 10; key++) { s.insert(key); }
+    std::uint64_t fingerprint = s.fingerprint();
+
+    Set<int>& alias = s;
+    s = std::move(alias);
+    ASSERT_EQ(s.size(), 10);
+    ASSERT_EQ(std::vector<int>(s.begin(), s.end()), std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    ASSERT_EQ(s.fingerprint(), fingerprint);
+}
+
+TEST(FingerprintTestSuite, FingerprintTest) {
+    Set<int> s;
+    Set<int> r;
+    for (int key : {5, 3, 6, 1, 9}) { s.insert(key); }
+    for (int key : {9, 1, 6, 3, 5}) { r.insert(key); }
+
+    ASSERT_EQ(s.fingerprint(), r.fingerprint());
+    ASSERT_TRUE(s == r);
+
+    s.erase(3);
+    s.insert(4);
+    ASSERT_NE(s.fingerprint(), r.fingerprint());
+    ASSERT_FALSE(s == r);
+
+    s.erase(s.find(4));
+    s.insert(3);
+    ASSERT_TRUE(s == r);
+
+    Set<int> upper = s.split(5);
+    ASSERT_FALSE(s == r);
+    s.join(upper);
+    ASSERT_EQ(s.fingerprint(), r.fingerprint());
+
+    Set<int> overlapping;
+    overlapping.insert(5);
+    overlapping.insert(7);
+    r.join(overlapping);
+    r.erase_range(7, 8);
+    ASSERT_EQ(s.fingerprint(), r.fingerprint());
+    ASSERT_TRUE(s == r);
+
+    const Set<int>& view = s;
+    ASSERT_FALSE(view != r);
+}
+
+struct CaseInsensitiveLess {
+    bool operator()(const std::string& a, const std::string& b) const {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+            [](unsigned char x, unsigned char y) { return std::tolower(x) < std::tolower(y); });
+    }
+};
+
+TEST(FingerprintTestSuite, MovedFromAndCustomCompareTest) {
+    Set<int> a;
+    Set<int> c;
+    a.insert(5);
+    c.insert(3);
+
+    Set<int> b(std::move(a));
+    a.insert(3);
+    ASSERT_TRUE(a == c);
+    b = std::move(a);
+    a.insert(3);
+    ASSERT_TRUE(a == c);
+    ASSERT_TRUE(b == c);
+
+    typedef Set<std::string, iterator_order_traits::inorder_iterator_tag, CaseInsensitiveLess> NameSet;
+    NameSet upper;
+    NameSet lower;
+    upper.insert("Hello");
+    lower.insert("hello");
+    ASSERT_TRUE(upper == lower);
+
+    ASSERT_TRUE(upper.erase("HELLO"));
+    ASSERT_EQ(upper.size(), 0);
+    ASSERT_EQ(upper.fingerprint(), 0);
+
+    // Reinserting over a tombstone keeps the stored spelling
+    NameSet stored;
+    for (const char* key : {"a", "b", "c", "hello"}) {
+        stored.insert(key);
+        lower.insert(key);
+    }
+    lower.set_compaction_threshold(0.9);
+    lower.erase("hello");
+    ASSERT_EQ(lower.tombstones(), 1);
+    lower.insert("HELLO");
+    ASSERT_EQ(*lower.find("hello"), "hello");
+    ASSERT_EQ(lower.fingerprint(), stored.fingerprint());
+}
+
+struct SumAggregate {
+    typedef long value_type;
+
+    static value_type identity() { return 0; }
+    static value_type lift(int key) { return key; }
+    static value_type combine(value_type a, value_type b) { return a + b; }
+};
+
+struct MaxGapAggregate {
+    struct value_type {
+        int first, last, gap;
+        bool empty;
+    };
+
+    static value_type identity() { return {0, 0, 0, true}; }
+    static value_type lift(int key) { return {key, key, 0, false}; }
+    static value_type combine(value_type a, value_type b) {
+        if (a.empty) { return b; }
+        if (b.empty) { return a; }
+        return {a.first, b.last, std::max({a.gap, b.gap, b.first - a.last}), false};
+    }
+};
+
+TEST(AggregateTestSuite, RangeSumTest) {
+    typedef Set<int, iterator_order_traits::inorder_iterator_tag, std::less<int>, std::allocator<int>, 0,
+        tree_shape_traits::static_shape_tag, SumAggregate> SumSet;
+    SumSet s;
+    std::set<int> reference;
+    for (int i = 0; i < 500; i++) {
+        int key = (i * 263 + 1) % 1000;
+        s.insert(key);
+        reference.insert(key);
+    }
+    auto expected = [&](int lo, int hi) {
+        long sum = 0;
+        for (auto it = reference.lower_bound(lo); it != reference.end() && *it < hi; ++it) { sum += *it; }
+        return sum;
+    };
+
+    ASSERT_EQ(s.aggregate(), expected(0, 1000));
+    ASSERT_EQ(s.aggregate(100, 400), expected(100, 400));
+    ASSERT_EQ(s.aggregate(400, 100), 0);
+
+    for (int key = 0; key < 1000; key += 3) {
+        s.erase(key);
+        reference.erase(key);
+    }
+    s.erase_range(700, 750);
+    for (int key = 700; key < 750; key++) { reference.erase(key); }
+    ASSERT_EQ(s.aggregate(0, 1000), expected(0, 1000));
+    ASSERT_EQ(s.aggregate(250, 777), expected(250, 777));
+
+    s.set_compaction_threshold(0.5);
+    for (int key = 1; key < 300; key += 3) {
+        s.erase(key);
+        reference.erase(key);
+    }
+    ASSERT_EQ(s.aggregate(0, 500), expected(0, 500));
+
+    SumSet upper = s.split(600);
+    ASSERT_EQ(s.aggregate(), expected(0, 600));
+    ASSERT_EQ(upper.aggregate(), expected(600, 1000));
+    s.join(upper);
+    s.optimize_layout();
+    ASSERT_EQ(s.aggregate(123, 987), expected(123, 987));
+}
+
+TEST(AggregateTestSuite, SplayOrderedAggregateTest) {
+    typedef Set<int, iterator_order_traits::inorder_iterator_tag, std::less<int>, std::allocator<int>, 4,
+        tree_shape_traits::splay_shape_tag, MaxGapAggregate> GapSet;
+    GapSet s;
+    for (int key : {10, 20, 25, 60, 61, 90}) { s.insert(key); }
+
+    ASSERT_EQ(s.aggregate().gap, 35);
+    ASSERT_TRUE(s.contains(61));
+    ASSERT_EQ(s.aggregate(0, 60).gap, 10);
+    ASSERT_EQ(s.aggregate(61, 100).gap, 29);
+
+    s.erase(60);
+    ASSERT_TRUE(s.contains(10));
+    ASSERT_EQ(s.aggregate().gap, 36);
+    ASSERT_TRUE(s.aggregate(30, 60).empty);
+}
+
+TEST(MapTestSuite, InsertLookupTest) {
+    Map<int, std::string> m;
+    for (int key : {5, 3, 8, 1, 4}) { m.try_emplace(key, std::to_string(key)); }
+
+    ASSERT_EQ(m.size(), 5);
+    ASSERT_FALSE(m.try_emplace(3, "three").second);
+    ASSERT_EQ(m.at(3), "3");
+    ASSERT_TRUE(m.insert_or_assign(3, "three").second == false);
+    ASSERT_EQ(m.at(3), "three");
+    ASSERT_TRUE(m.insert_or_assign(7, "7").second);
+    m[9] = "9";
+    m[1] += "!";
+
+    ASSERT_TRUE(m.erase(4));
+    ASSERT_FALSE(m.erase(4));
+    ASSERT_FALSE(m.contains(4));
+    ASSERT_THROW(m.at(4), std::out_of_range);
+    ASSERT_EQ(m.find(4), m.end());
+    ASSERT_EQ(m.find(8)->second, "8");
+
+    std::string& five = m.at(5);
+    for (int key = 100; key < 200; key++) { m[key] = "x"; }
+    ASSERT_EQ(&five, &m.at(5));
+
+    std::vector<std::pair<int, std::string>> items;
+    for (auto it = m.begin(); it != m.end(); ++it) { items.emplace_back(it.key(), it.value()); }
+    items.resize(7);
+    ASSERT_EQ(items, (std::vector<std::pair<int, std::string>>({
+        {1, "1!"}, {3, "three"}, {5, "5"}, {7, "7"}, {8, "8"}, {9, "9"}, {100, "x"}})));
+
+    for (auto it = m.begin(); it != m.end();) {
+        if (it.key() >= 100) { it = m.erase(it); }
+        else { ++it; }
+    }
+    ASSERT_EQ(m.size(), 6);
+    Map<int, std::string> copy = m;
+    copy[3] = "3";
+    ASSERT_EQ(m.at(3), "three");
+    ASSERT_EQ((*copy.begin()).second, "1!");
+}
+
+TEST(MapTestSuite, EraseKeepsIteratorsTest) {
+    Map<int, int> m;
+    for (int key : {5, 3, 8, 1, 4, 7, 9}) { m[key] = key * 10; }
+
+    auto it = m.find(8);
+    ASSERT_TRUE(m.erase(5));
+    std::vector<int> values;
+    for (; it != m.end(); ++it) { values.push_back(it->second); }
+    ASSERT_EQ(values, std::vector<int>({80, 90}));
+
+    it = m.find(3);
+    auto next = m.erase(m.find(4));
+    ASSERT_EQ(next.key(), 7);
+    ASSERT_EQ((++it).key(), 7);
+}
+
+TEST(MapTestSuite, NoAllocationOnExistingKeyTest) {
+    typedef Map<int, std::vector<int>, std::less<int>, CountingAllocator<std::vector<int>>> CountingMap;
+    CountingMap m;
+    for (int key = 0; key < 64; key++) { m.try_emplace(key, 3, key); }
+    m.erase(10);
+    m.erase(20);
+    m.try_emplace(10, 1, 10);
+
+    std::size_t before = CountingAllocatorBase::total_allocations;
+    for (int key = 0; key < 64; key++) {
+        ASSERT_EQ(m.try_emplace(key).second, key == 20);
+        if (key != 20) { ASSERT_FALSE(m.insert_or_assign(key, m.at(key)).second); }
+    }
+    m.erase(20);
+    ASSERT_EQ(CountingAllocatorBase::total_allocations, before + 1);   // the node for 20; its value reused a free slot
+    ASSERT_EQ(m.at(10), std::vector<int>({10}));
+    ASSERT_EQ(m.size(), 63);
+}